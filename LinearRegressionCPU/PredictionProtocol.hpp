@@ -0,0 +1,69 @@
+// PredictionProtocol.hpp
+// Binary protocol between prediction_server and its clients over a Unix domain socket (POSIX only).
+// Both ends run on the same machine, so values are sent in native byte order.
+//
+//   request : RequestHeader  + rows * cols doubles (raw MYCT..CHMAX features, row-major)
+//   response: ResponseHeader + rows doubles (predicted PRP), nothing else if status != 0
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+const uint32_t kPredictMagic = 0x50555043;   // "CPUP"
+const uint32_t kMaxRowsPerRequest = 1 << 16;
+
+struct RequestHeader {
+    uint32_t magic;
+    uint32_t rows;
+    uint32_t cols;
+};
+
+struct ResponseHeader {
+    uint32_t magic;
+    uint32_t rows;
+    uint32_t status;    // 0 = ok, 1 = bad request, 2 = scoring error
+};
+
+// Read exactly n bytes; false on EOF or error
+inline bool readAll(int fd, void* buf, size_t n) {
+    char* p = static_cast<char*>(buf);
+    while (n > 0) {
+        ssize_t got = ::read(fd, p, n);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        p += got;
+        n -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+// Write exactly n bytes; false on error
+inline bool writeAll(int fd, const void* buf, size_t n) {
+    const char* p = static_cast<const char*>(buf);
+    while (n > 0) {
+        ssize_t sent = ::write(fd, p, n);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        p += sent;
+        n -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+// Client side: connect to the server's socket; -1 on failure
+inline int connectTo(const std::string& path) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        if (fd >= 0) ::close(fd);
+        return -1;
+    }
+    return fd;
+}
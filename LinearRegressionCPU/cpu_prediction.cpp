@@ -5,9 +5,15 @@
 #include <random>
 #include <algorithm>
 #include <cmath>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+#include <string>
 #include "../LinearSystem/Vector.hpp"
 #include "../LinearSystem/Matrix.hpp"
 #include "../LinearSystem/LeastSquaresSystem.hpp"
+#include "../LinearSystem/LinearModel.hpp"
+#include "../LinearSystem/Resampling.hpp"
 
 // Load CSV data with comma separation
 void loadData(const std::string& filename,
@@ -65,7 +71,8 @@ void splitData(const std::vector<std::vector<double>>& features,
                std::vector<std::vector<double>>& trainFeatures,
                std::vector<double>& trainTargets,
                std::vector<std::vector<double>>& testFeatures,
-               std::vector<double>& testTargets) {
+               std::vector<double>& testTargets,
+               unsigned seed) {
     size_t N = features.size();
     if (N == 0 || targets.size() != N) {
         std::cerr << "Empty dataset or size mismatch.\n";
@@ -74,12 +81,8 @@ void splitData(const std::vector<std::vector<double>>& features,
     std::vector<size_t> indices(N);
     for (size_t i = 0; i < N; ++i) indices[i] = i;
 
-    
-    // Use fixed seed for reproducibility
-    // int rd = 42;
-    // std::mt19937 g(rd); // <-- fixed seed
-    std::random_device rd;
-    std::mt19937 g(rd());
+    // Same seed, same split (--seed); random otherwise
+    std::mt19937 g(seed);
     std::shuffle(indices.begin(), indices.end(), g);
 
     size_t trainSize = static_cast<size_t>(0.8 * N);
@@ -99,24 +102,6 @@ void splitData(const std::vector<std::vector<double>>& features,
     }
 }
 
-// Convert std::vector<std::vector<double>> to Matrix (1-based indexing)
-Matrix toMatrix(const std::vector<std::vector<double>>& data) {
-    if (data.empty()) return Matrix(0, 0);
-    int rows = static_cast<int>(data.size());
-    int cols = static_cast<int>(data[0].size());
-    Matrix M(rows, cols, "M");
-    for (int i = 0; i < rows; ++i) {
-        if (data[i].size() != static_cast<size_t>(cols)) {
-            std::cerr << "Inconsistent feature vector size in data.\n";
-            exit(1);
-        }
-        for (int j = 0; j < cols; ++j) {
-            M(i + 1, j + 1) = data[i][j];
-        }
-    }
-    return M;
-}
-
 // Convert std::vector<double> to Vector (1-based indexing)
 Vector toVector(const std::vector<double>& data) {
     Vector v(static_cast<int>(data.size()), 0.0);
@@ -133,15 +118,46 @@ double computeRMSE(const Vector& predictions, const Vector& targets) {
         std::cerr << "Prediction and target vector sizes do not match.\n";
         exit(1);
     }
-    double sumSq = 0.0;
-    for (int i = 1; i <= n; ++i) {
-        double diff = predictions(i) - targets(i);
-        sumSq += diff * diff;
-    }
+    const double* p = predictions.data();
+    const double* t = targets.data();
+    double sumSq = Parallel::sum(n, [p, t](int begin, int end) { return VectorKernels::sumSqDiff(p + begin, t + begin, end - begin); });
     return std::sqrt(sumSq / n);
 }
 
-int main() {
+// Non-negative integer argument; false if s is not one
+bool parseCount(const char* s, long long max, long long& value) {
+    char* end;
+    errno = 0;
+    value = std::strtoll(s, &end, 10);
+    return end != s && *end == '\0' && errno == 0 && value >= 0 && value <= max;
+}
+
+int usage() {
+    std::cerr << "Usage: ./cpu_prediction [--reproducible] [--threads N] [--seed S]\n"
+              << "  --reproducible  same sums for any thread count\n"
+              << "  --threads N     worker threads (0 = all cores)\n"
+              << "  --seed S        fixed train/test split (random by default)\n";
+    return 1;
+}
+
+// ./cpu_prediction [--reproducible] [--threads N] [--seed S]
+int main(int argc, char* argv[]) {
+    unsigned seed = std::random_device{}();
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        long long value;
+        if (arg == "--reproducible") Parallel::setReproducible(true);
+        else if (arg == "--threads" && i + 1 < argc && parseCount(argv[i + 1], 4096, value)) {
+            Parallel::setThreads(static_cast<int>(value));
+            ++i;
+        } else if (arg == "--seed" && i + 1 < argc && parseCount(argv[i + 1], std::numeric_limits<unsigned>::max(), value)) {
+            seed = static_cast<unsigned>(value);
+            ++i;
+        } else {
+            return usage();
+        }
+    }
+
     std::vector<std::vector<double>> features;
     std::vector<double> targets;
 
@@ -149,15 +165,16 @@ int main() {
 
     std::vector<std::vector<double>> trainFeatures, testFeatures;
     std::vector<double> trainTargets, testTargets;
-    splitData(features, targets, trainFeatures, trainTargets, testFeatures, testTargets);
+    splitData(features, targets, trainFeatures, trainTargets, testFeatures, testTargets, seed);
 
-    Matrix A = toMatrix(trainFeatures);
-    Vector b = toVector(trainTargets);
+    // z-score the raw MYCT..CHMAX columns, then add an intercept column
+    FeaturePipeline pipeline;
+    pipeline.add<ZScoreStage>().add<InterceptStage>();
+    LinearModel model(std::move(pipeline));
 
     double lambda = 0.1;
     // cout << "Input lambda: "; cin >> lambda;
-    LeastSquaresSystem lss(&A, &b, lambda); // lambda = 0.1 for ridge regularization
-    Vector x = lss.solve();
+    Vector x = model.fit(trainFeatures, trainTargets, lambda); // lambda = 0.1 for ridge regularization
 
     std::cout << "Learned parameters (x):\n";
     for (int i = 1; i <= x.size(); ++i) {
@@ -165,14 +182,29 @@ int main() {
     }
     std::cout << "\n";
 
-    Matrix A_test = toMatrix(testFeatures);
     Vector b_test = toVector(testTargets);
 
-    Vector predictions = A_test * x;
+    Vector predictions = model.predict(testFeatures);
 
     double rmse = computeRMSE(predictions, b_test);
 
     std::cout << "Test RMSE: " << rmse << std::endl;
 
+    // Fitted transform + coefficients, loaded by prediction_server
+    model.save("cpu_model.txt");
+
+    // 95% bootstrap intervals on the expanded training design (fixed seed, any thread count)
+    Matrix Z = model.pipeline().transform(trainFeatures);
+    Vector b = toVector(trainTargets);
+    Resampling resampling(Z, b, lambda);
+    ResamplingResult ci = resampling.bootstrap(10000, 42);
+
+    std::cout << "Bootstrap 95% intervals (" << ci.resamples << " resamples):\n";
+    for (size_t j = 0; j < ci.coef.size(); ++j) {
+        std::cout << "  x" << j + 1 << ": [" << ci.coef[j].lower << ", " << ci.coef[j].upper << "]\n";
+    }
+    std::cout << "  Out-of-bag RMSE: [" << ci.rmse.lower << ", " << ci.rmse.upper << "]\n";
+    if (ci.skipped > 0) std::cout << "  (" << ci.skipped << " singular resamples skipped)\n";
+
     return 0;
 }
\ No newline at end of file
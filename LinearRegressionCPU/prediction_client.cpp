@@ -0,0 +1,93 @@
+// Load generator for prediction_server (POSIX only): several connections send requests
+// back to back and the round-trip latency of each request is measured.
+//
+//   ./prediction_client [socket path] [connections] [requests per connection] [rows per request]
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include "PredictionProtocol.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+const int kFeatures = 6;   // MYCT, MMIN, MMAX, CACH, CHMIN, CHMAX
+
+// Send `requests` requests of `rows` random rows each; latencies in microseconds
+bool runConnection(const std::string& path, int id, int requests, int rows, std::vector<double>& latencies, double& lastPrediction) {
+    int fd = connectTo(path);
+    if (fd < 0) return false;
+
+    // Feature ranges roughly matching machine.data
+    std::mt19937 g(1234 + id);
+    std::uniform_real_distribution<double> myct(17, 1500), mmin(64, 32000), mmax(64, 64000),
+                                           cach(0, 256), chmin(0, 52), chmax(0, 176);
+    std::vector<double> features(static_cast<size_t>(rows) * kFeatures);
+    std::vector<double> predictions(rows);
+    bool ok = true;
+
+    for (int k = 0; k < requests && ok; ++k) {
+        for (int r = 0; r < rows; ++r) {
+            double* f = features.data() + static_cast<size_t>(r) * kFeatures;
+            f[0] = myct(g); f[1] = mmin(g); f[2] = mmax(g);
+            f[3] = cach(g); f[4] = chmin(g); f[5] = chmax(g);
+        }
+        RequestHeader req{kPredictMagic, static_cast<uint32_t>(rows), kFeatures};
+        ResponseHeader res;
+
+        Clock::time_point start = Clock::now();
+        ok = writeAll(fd, &req, sizeof(req))
+          && writeAll(fd, features.data(), sizeof(double) * features.size())
+          && readAll(fd, &res, sizeof(res))
+          && res.magic == kPredictMagic && res.status == 0 && res.rows == static_cast<uint32_t>(rows)
+          && readAll(fd, predictions.data(), sizeof(double) * rows);
+        latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    if (ok) lastPrediction = predictions[rows - 1];
+    ::close(fd);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    std::string path = argc > 1 ? argv[1] : "/tmp/cpu_prediction.sock";
+    int connections = argc > 2 ? std::stoi(argv[2]) : 8;
+    int requests = argc > 3 ? std::stoi(argv[3]) : 2000;
+    int rows = argc > 4 ? std::stoi(argv[4]) : 1;
+    if (connections < 1 || requests < 1 || rows < 1) {
+        std::cerr << "Connections, requests and rows must be positive\n";
+        return 1;
+    }
+
+    std::vector<std::vector<double>> latencies(connections);
+    std::vector<double> lastPrediction(connections, 0.0);
+    std::vector<char> ok(connections, 0);
+    std::vector<std::thread> threads;
+
+    Clock::time_point start = Clock::now();
+    for (int c = 0; c < connections; ++c) {
+        threads.emplace_back([&, c] {
+            ok[c] = runConnection(path, c, requests, rows, latencies[c], lastPrediction[c]);
+        });
+    }
+    for (auto& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> all;
+    for (int c = 0; c < connections; ++c) {
+        if (!ok[c]) {
+            std::cerr << "Connection " << c << " failed (is prediction_server running on " << path << "?)\n";
+            return 1;
+        }
+        all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+    }
+    std::sort(all.begin(), all.end());
+
+    std::cout << connections << " connections x " << requests << " requests x " << rows << " rows\n";
+    std::cout << "Throughput: " << all.size() / seconds << " req/s, " << all.size() * rows / seconds << " rows/s\n";
+    std::cout << "Latency: p50 " << all[all.size() / 2] << " us, p99 "
+              << all[std::min(all.size() - 1, all.size() * 99 / 100)] << " us\n";
+    std::cout << "Sample prediction: " << lastPrediction[0] << "\n";
+    return 0;
+}
@@ -0,0 +1,299 @@
+// Serves a model saved by cpu_prediction to local processes over a Unix domain socket (POSIX only).
+// Requests from all connections are coalesced into micro-batches and scored with one Matrix * Vector.
+//
+//   ./prediction_server [model file] [socket path] [max batch rows] [max wait us]
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <set>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../LinearSystem/LinearModel.hpp"
+#include "PredictionProtocol.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<bool> gStop(false);
+
+void onSignal(int) { gStop = true; }
+
+// One client request waiting for the batcher
+struct Job {
+    int rows;
+    std::vector<double> features;
+    std::vector<double> predictions;
+    bool ok = false;
+    bool done = false;
+    Clock::time_point enqueued;
+};
+
+class Batcher {
+private:
+    const LinearModel& mModel;
+    int mMaxRows;
+    std::chrono::microseconds mMaxWait;
+
+    std::mutex mMutex;
+    std::condition_variable mHasWork;
+    std::condition_variable mDone;
+    std::deque<Job*> mQueue;
+    bool mStopping = false;
+
+    // Metrics since the last report
+    std::mutex mStatsMutex;
+    std::vector<double> mLatencyUs;
+    long long mRows = 0;
+    long long mBatches = 0;
+    Clock::time_point mWindowStart = Clock::now();
+
+    // Predictions for the rows of `jobs`, stacked in order; throws if a row is rejected
+    void predict(const std::vector<Job*>& jobs, Vector& y) const {
+        int total = 0;
+        for (Job* job : jobs) total += job->rows;
+        ScratchScope scratch;   // Z is rebuilt for every batch without touching the heap
+        Matrix Z(total, mModel.pipeline().outDim(), "Z");
+        int r = 1;
+        for (Job* job : jobs) {
+            mModel.pipeline().transformRows(job->features.data(), job->rows, Z, r);
+            r += job->rows;
+        }
+        y = Z * mModel.coefficients();   // copied into y's own (heap) storage
+    }
+
+    void score(std::vector<Job*>& batch) {
+        int total = 0;
+        for (Job* job : batch) total += job->rows;
+        Vector y;
+        try {
+            predict(batch, y);
+            int offset = 0;
+            for (Job* job : batch) {
+                job->ok = true;
+                job->predictions.assign(y.data() + offset, y.data() + offset + job->rows);
+                offset += job->rows;
+            }
+        } catch (const std::exception&) {
+            // Score the jobs one by one, so only the requests with bad rows fail
+            for (Job* job : batch) {
+                try {
+                    predict({job}, y);
+                    job->ok = true;
+                    job->predictions.assign(y.data(), y.data() + job->rows);
+                } catch (const std::exception& e) {
+                    std::cerr << "Scoring error: " << e.what() << "\n";
+                    job->ok = false;
+                }
+            }
+        }
+
+        Clock::time_point now = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mStatsMutex);
+            for (Job* job : batch)
+                mLatencyUs.push_back(std::chrono::duration<double, std::micro>(now - job->enqueued).count());
+            mRows += total;
+            ++mBatches;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (Job* job : batch) job->done = true;
+        mDone.notify_all();
+    }
+
+public:
+    Batcher(const LinearModel& model, int maxRows, int maxWaitUs)
+    : mModel(model), mMaxRows(maxRows), mMaxWait(maxWaitUs) {}
+
+    // Called from connection threads; blocks until the job has been scored
+    void submit(Job& job) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        job.enqueued = Clock::now();
+        mQueue.push_back(&job);
+        mHasWork.notify_one();
+        mDone.wait(lock, [&] { return job.done; });
+    }
+
+    // Batcher thread: take the first waiting job, then keep collecting until the
+    // batch is full or the first job has waited mMaxWait. Returns once stop() was
+    // called and the queue is empty.
+    void run() {
+        std::vector<Job*> batch;
+        while (true) {
+            batch.clear();
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mHasWork.wait(lock, [&] { return !mQueue.empty() || mStopping; });
+                if (mQueue.empty()) return;
+                Clock::time_point deadline = mQueue.front()->enqueued + mMaxWait;
+                int rows = 0;
+                while (true) {
+                    while (!mQueue.empty() && (batch.empty() || rows + mQueue.front()->rows <= mMaxRows)) {
+                        rows += mQueue.front()->rows;
+                        batch.push_back(mQueue.front());
+                        mQueue.pop_front();
+                    }
+                    if (rows >= mMaxRows || !mQueue.empty()) break;
+                    if (!mHasWork.wait_until(lock, deadline, [&] { return !mQueue.empty(); })) break;
+                }
+            }
+            score(batch);
+        }
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+        mHasWork.notify_all();
+    }
+
+    // p50 / p99 latency and throughput since the previous report
+    void report() {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        double seconds = std::chrono::duration<double>(Clock::now() - mWindowStart).count();
+        if (!mLatencyUs.empty()) {
+            std::sort(mLatencyUs.begin(), mLatencyUs.end());
+            double p50 = mLatencyUs[mLatencyUs.size() / 2];
+            double p99 = mLatencyUs[std::min(mLatencyUs.size() - 1, mLatencyUs.size() * 99 / 100)];
+            std::cout << "[stats] " << mLatencyUs.size() / seconds << " req/s, " << mRows / seconds << " rows/s, "
+                      << "avg batch " << static_cast<double>(mRows) / mBatches << " rows, "
+                      << "latency p50 " << p50 << " us, p99 " << p99 << " us" << std::endl;
+        }
+        mLatencyUs.clear();
+        mRows = 0;
+        mBatches = 0;
+        mWindowStart = Clock::now();
+    }
+};
+
+// Open client sockets, so that shutdown can unblock their threads
+static std::mutex gConnMutex;
+static std::set<int> gConnFds;
+
+// A connection thread; the accept loop joins and drops it once it has finished
+struct Connection {
+    std::thread thread;
+    std::atomic<bool> finished{false};
+};
+
+void serveConnection(int fd, Batcher& batcher, int cols) {
+    RequestHeader req;
+    while (readAll(fd, &req, sizeof(req))) {
+        ResponseHeader res{kPredictMagic, req.rows, 0};
+        if (req.magic != kPredictMagic || req.cols != static_cast<uint32_t>(cols)
+            || req.rows == 0 || req.rows > kMaxRowsPerRequest) {
+            res.status = 1;
+            writeAll(fd, &res, sizeof(res));
+            break;
+        }
+        Job job;
+        job.rows = static_cast<int>(req.rows);
+        job.features.resize(static_cast<size_t>(req.rows) * cols);
+        if (!readAll(fd, job.features.data(), sizeof(double) * job.features.size())) break;
+
+        batcher.submit(job);
+        if (!job.ok) res.status = 2;
+        if (!writeAll(fd, &res, sizeof(res))) break;
+        if (job.ok && !writeAll(fd, job.predictions.data(), sizeof(double) * job.predictions.size())) break;
+    }
+    std::lock_guard<std::mutex> lock(gConnMutex);
+    gConnFds.erase(fd);
+    ::close(fd);
+}
+
+int main(int argc, char* argv[]) {
+    std::string modelPath = argc > 1 ? argv[1] : "cpu_model.txt";
+    std::string socketPath = argc > 2 ? argv[2] : "/tmp/cpu_prediction.sock";
+    int maxRows = argc > 3 ? std::stoi(argv[3]) : 256;
+    int maxWaitUs = argc > 4 ? std::stoi(argv[4]) : 200;
+
+    LinearModel model;
+    try {
+        model = LinearModel::load(modelPath);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n(run ./cpu_prediction first to create " << modelPath << ")\n";
+        return 1;
+    }
+
+    int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (listenFd < 0 || socketPath.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Cannot create socket " << socketPath << "\n";
+        return 1;
+    }
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    ::unlink(socketPath.c_str());
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(listenFd, 128) < 0) {
+        std::cerr << "Cannot listen on " << socketPath << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "Serving " << modelPath << " (" << model.pipeline().inDim() << " features) on " << socketPath
+              << ", batches of up to " << maxRows << " rows / " << maxWaitUs << " us" << std::endl;
+
+    Batcher batcher(model, maxRows, maxWaitUs);
+    std::thread batchThread([&] { batcher.run(); });
+
+    std::list<Connection> connections;
+    int cols = model.pipeline().inDim();
+    Clock::time_point lastReport = Clock::now();
+    while (!gStop) {
+        pollfd pfd{listenFd, POLLIN, 0};
+        if (::poll(&pfd, 1, 200) > 0) {
+            int fd = ::accept(listenFd, nullptr, nullptr);
+            if (fd >= 0) {
+                std::lock_guard<std::mutex> lock(gConnMutex);
+                gConnFds.insert(fd);
+                connections.emplace_back();
+                Connection& c = connections.back();
+                c.thread = std::thread([&c, fd, &batcher, cols] {
+                    serveConnection(fd, batcher, cols);
+                    c.finished = true;
+                });
+            }
+        }
+        // Reap the connections that have closed
+        for (auto it = connections.begin(); it != connections.end();) {
+            if (it->finished) {
+                it->thread.join();
+                it = connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (Clock::now() - lastReport > std::chrono::seconds(2)) {
+            batcher.report();
+            lastReport = Clock::now();
+        }
+    }
+
+    // Stop accepting, unblock and join the connections (the batcher still answers
+    // jobs already submitted), then stop the batcher
+    ::close(listenFd);
+    ::unlink(socketPath.c_str());
+    {
+        std::lock_guard<std::mutex> lock(gConnMutex);
+        for (int fd : gConnFds) ::shutdown(fd, SHUT_RDWR);
+    }
+    for (auto& c : connections) c.thread.join();
+    batcher.stop();
+    batchThread.join();
+    batcher.report();
+    std::cout << "Server stopped" << std::endl;
+    return 0;
+}
@@ -0,0 +1,184 @@
+// End-to-end test of prediction_server (POSIX only): starts ./prediction_server on a temporary
+// socket with a small model, then checks single, concurrent and malformed requests against
+// LinearModel::predict.
+//
+//   make service_test && ./service_test
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include "../LinearSystem/LinearModel.hpp"
+#include "PredictionProtocol.hpp"
+
+const int kFeatures = 6;
+
+// One round trip; predictions are only read back when the status is 0
+bool roundTrip(int fd, const RequestHeader& req, const std::vector<double>& features,
+               ResponseHeader& res, std::vector<double>& predictions) {
+    if (!writeAll(fd, &req, sizeof(req)) || !writeAll(fd, features.data(), sizeof(double) * features.size())
+        || !readAll(fd, &res, sizeof(res)) || res.magic != kPredictMagic)
+        return false;
+    predictions.assign(res.status == 0 ? res.rows : 0, 0.0);
+    return readAll(fd, predictions.data(), sizeof(double) * predictions.size());
+}
+
+// Rows with features in [0, 100); the log stage rejects any value <= -1
+std::vector<double> randomRows(int rows, std::mt19937& g) {
+    std::uniform_real_distribution<double> U(0.0, 100.0);
+    std::vector<double> features(static_cast<size_t>(rows) * kFeatures);
+    for (double& v : features) v = U(g);
+    return features;
+}
+
+// Server predictions against LinearModel::predict, row by row
+bool matches(const LinearModel& model, const std::vector<double>& features, const std::vector<double>& predictions) {
+    for (size_t r = 0; r < predictions.size(); ++r) {
+        std::vector<double> row(features.begin() + r * kFeatures, features.begin() + (r + 1) * kFeatures);
+        double expected = model.predict(row);
+        if (std::fabs(predictions[r] - expected) > 1e-9 * (1.0 + std::fabs(expected))) return false;
+    }
+    return true;
+}
+
+const char* yesNo(bool b) { return b ? "yes" : "NO"; }
+
+int main() {
+    char dir[] = "/tmp/service_testXXXXXX";
+    if (!::mkdtemp(dir)) {
+        std::cerr << "Cannot create a temporary directory\n";
+        return 1;
+    }
+    std::string modelPath = std::string(dir) + "/model.txt";
+    std::string socketPath = std::string(dir) + "/server.sock";
+
+    // A model whose log stage fails on negative inputs, so scoring errors can be provoked
+    std::mt19937 g(3);
+    std::vector<std::vector<double>> rows;
+    std::vector<double> targets;
+    std::normal_distribution<double> noise(0.0, 1.0);
+    for (int i = 0; i < 500; ++i) {
+        std::vector<double> x = randomRows(1, g);
+        targets.push_back(10.0 + std::log1p(x[0]) - 2.0 * std::log1p(x[3]) + 0.5 * std::log1p(x[5]) + noise(g));
+        rows.push_back(x);
+    }
+    FeaturePipeline pipeline;
+    pipeline.add<LogStage>().add<ZScoreStage>().add<InterceptStage>();
+    LinearModel model(std::move(pipeline));
+    model.fit(rows, targets, 0.1);
+    model.save(modelPath);
+
+    std::cout << "=== Prediction Service Test ===\n";
+    pid_t server = ::fork();
+    if (server == 0) {
+        int devNull = ::open("/dev/null", O_WRONLY);
+        ::dup2(devNull, 1);
+        ::dup2(devNull, 2);
+        ::execl("./prediction_server", "prediction_server", modelPath.c_str(), socketPath.c_str(), "64", "2000",
+                static_cast<char*>(nullptr));
+        ::_exit(127);
+    }
+    int fd = -1;
+    for (int attempt = 0; attempt < 250 && fd < 0; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        fd = connectTo(socketPath);
+    }
+    if (fd < 0) {
+        std::cerr << "Server did not start (run make service first)\n";
+        ::kill(server, SIGKILL);
+        ::waitpid(server, nullptr, 0);
+        std::remove(modelPath.c_str());
+        ::rmdir(dir);
+        return 1;
+    }
+    bool passed = true;
+
+    // One request with several rows
+    {
+        std::vector<double> features = randomRows(10, g), predictions;
+        ResponseHeader res;
+        bool ok = roundTrip(fd, {kPredictMagic, 10, kFeatures}, features, res, predictions)
+               && res.status == 0 && res.rows == 10 && matches(model, features, predictions);
+        std::cout << "Single request (10 rows) matches LinearModel::predict: " << yesNo(ok) << "\n";
+        passed = passed && ok;
+        ::close(fd);
+    }
+
+    // Concurrent connections whose requests get coalesced into batches. Every 7th request of
+    // the odd connections holds a negative value: only that request may fail, with status 2.
+    {
+        const int connections = 8, requests = 100;
+        std::vector<int> good(connections, 0), rejected(connections, 0), wrong(connections, 0);
+        std::vector<std::thread> clients;
+        for (int c = 0; c < connections; ++c) {
+            clients.emplace_back([&, c] {
+                std::mt19937 local(100 + c);
+                std::uniform_int_distribution<int> rowCount(1, 16);
+                int cfd = connectTo(socketPath);
+                for (int k = 0; k < requests; ++k) {
+                    int n = rowCount(local);
+                    std::vector<double> features = randomRows(n, local), predictions;
+                    bool bad = c % 2 == 1 && k % 7 == 0;
+                    if (bad) features[static_cast<size_t>(n - 1) * kFeatures + 2] = -5.0;
+                    ResponseHeader res;
+                    if (cfd < 0 || !roundTrip(cfd, {kPredictMagic, static_cast<uint32_t>(n), kFeatures}, features, res, predictions))
+                        ++wrong[c];
+                    else if (bad && res.status == 2) ++rejected[c];
+                    else if (!bad && res.status == 0 && matches(model, features, predictions)) ++good[c];
+                    else ++wrong[c];
+                }
+                if (cfd >= 0) ::close(cfd);
+            });
+        }
+        for (auto& t : clients) t.join();
+        int totalGood = 0, totalRejected = 0, totalWrong = 0;
+        for (int c = 0; c < connections; ++c) {
+            totalGood += good[c];
+            totalRejected += rejected[c];
+            totalWrong += wrong[c];
+        }
+        std::cout << "Concurrent requests: " << connections * requests << " sent, " << totalGood << " correct, "
+                  << totalRejected << " bad requests rejected alone, " << totalWrong << " wrong\n";
+        passed = passed && totalWrong == 0;
+    }
+
+    // Malformed requests get status 1 and the connection is closed
+    {
+        struct Case { const char* label; RequestHeader req; };
+        const Case cases[] = {
+            {"wrong column count", {kPredictMagic, 2, kFeatures + 1}},
+            {"wrong magic", {0x12345678, 2, kFeatures}},
+            {"zero rows", {kPredictMagic, 0, kFeatures}},
+        };
+        for (const Case& c : cases) {
+            int cfd = connectTo(socketPath);
+            ResponseHeader res{};
+            char extra;
+            bool ok = cfd >= 0 && writeAll(cfd, &c.req, sizeof(c.req)) && readAll(cfd, &res, sizeof(res))
+                   && res.status == 1 && !readAll(cfd, &extra, 1);
+            std::cout << "Malformed request (" << c.label << ") gets status 1: " << yesNo(ok) << "\n";
+            passed = passed && ok;
+            if (cfd >= 0) ::close(cfd);
+        }
+    }
+
+    // SIGTERM: the server drains, removes its socket and exits with 0
+    ::kill(server, SIGTERM);
+    int status = 0;
+    ::waitpid(server, &status, 0);
+    bool clean = WIFEXITED(status) && WEXITSTATUS(status) == 0 && ::access(socketPath.c_str(), F_OK) != 0;
+    std::cout << "Server shut down cleanly: " << yesNo(clean) << "\n";
+    passed = passed && clean;
+
+    std::remove(modelPath.c_str());
+    ::rmdir(dir);
+    std::cout << "\n=== Test " << (passed ? "Completed" : "FAILED") << " ===\n";
+    return passed ? 0 : 1;
+}
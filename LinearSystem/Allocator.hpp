@@ -0,0 +1,169 @@
+// Allocator.hpp
+#pragma once
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+// Storage provider for Matrix and Vector. Every block is 64-byte aligned.
+class Allocator {
+public:
+    static const size_t kAlign = 64;
+
+    virtual ~Allocator() = default;
+    virtual void* allocate(size_t bytes) = 0;
+    virtual void deallocate(void* p, size_t bytes) = 0;
+
+    // True for arena storage that is freed when its scope ends, not by deallocate()
+    virtual bool scoped() const { return false; }
+
+    static size_t roundUp(size_t bytes) { return (bytes + kAlign - 1) / kAlign * kAlign; }
+
+    // Allocator picked up by new matrices and vectors on this thread (heap unless a ScratchScope is open)
+    static Allocator*& current();
+
+    // Allocator for an object that takes over a buffer from `source`: arena storage can be
+    // rewound while the new owner is still alive, so its contents are copied to the heap
+    static Allocator* adoptable(Allocator* source);
+};
+
+// Counters for checking how many allocations a piece of code performs
+struct AllocStats {
+    static std::atomic<long long>& heapCalls() { static std::atomic<long long> n(0); return n; }
+    static std::atomic<long long>& heapBytes() { static std::atomic<long long> n(0); return n; }
+    static std::atomic<long long>& arenaCalls() { static std::atomic<long long> n(0); return n; }
+
+    static void reset() { heapCalls() = 0; heapBytes() = 0; arenaCalls() = 0; }
+};
+
+class HeapAllocator : public Allocator {
+public:
+    void* allocate(size_t bytes) override {
+        ++AllocStats::heapCalls();
+        AllocStats::heapBytes() += static_cast<long long>(bytes);
+        return ::operator new(roundUp(bytes), std::align_val_t(kAlign));
+    }
+    void deallocate(void* p, size_t /*bytes*/) override {
+        ::operator delete(p, std::align_val_t(kAlign));
+    }
+
+    static HeapAllocator& instance() {
+        static HeapAllocator heap;
+        return heap;
+    }
+};
+
+inline Allocator*& Allocator::current() {
+    thread_local Allocator* alloc = &HeapAllocator::instance();
+    return alloc;
+}
+
+inline Allocator* Allocator::adoptable(Allocator* source) {
+    return source->scoped() ? &HeapAllocator::instance() : source;
+}
+
+// Bump allocator for solver temporaries. Memory is only given back by rewinding to a mark;
+// when a rewind empties the arena and more than one chunk was needed, the chunks are merged
+// into one, so after the first (warmup) call the same workload needs no heap allocation.
+class ScratchArena : public Allocator {
+public:
+    struct Mark { size_t chunk; size_t offset; };
+
+private:
+    struct Chunk { char* data; size_t size; };
+    std::vector<Chunk> mChunks;
+    size_t mChunk = 0;
+    size_t mOffset = 0;
+    size_t mPeak = 0;   // bytes in use at the high-water mark since the last merge
+
+    size_t used() const {
+        size_t total = mOffset;
+        for (size_t c = 0; c < mChunk && c < mChunks.size(); ++c) total += mChunks[c].size;
+        return total;
+    }
+
+    void addChunk(size_t minBytes) {
+        size_t last = mChunks.empty() ? 0 : mChunks.back().size;
+        size_t size = roundUp(std::max({minBytes, 2 * last, size_t(64 * 1024)}));
+        mChunks.push_back({static_cast<char*>(HeapAllocator::instance().allocate(size)), size});
+    }
+
+    void releaseChunks() {
+        for (auto& c : mChunks) HeapAllocator::instance().deallocate(c.data, c.size);
+        mChunks.clear();
+    }
+
+public:
+    ScratchArena() = default;
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+    ~ScratchArena() { releaseChunks(); }
+
+    void* allocate(size_t bytes) override {
+        ++AllocStats::arenaCalls();
+        bytes = roundUp(std::max(bytes, size_t(1)));
+        while (mChunk < mChunks.size() && mOffset + bytes > mChunks[mChunk].size) {
+            ++mChunk;
+            mOffset = 0;
+        }
+        if (mChunk == mChunks.size()) addChunk(bytes);
+        void* p = mChunks[mChunk].data + mOffset;
+        mOffset += bytes;
+        mPeak = std::max(mPeak, used());
+        return p;
+    }
+
+    // Individual blocks are freed all at once by rewind()
+    void deallocate(void* /*p*/, size_t /*bytes*/) override {}
+    bool scoped() const override { return true; }
+
+    Mark mark() const { return {mChunk, mOffset}; }
+
+    void rewind(const Mark& m) {
+        mChunk = m.chunk;
+        mOffset = m.offset;
+        if (mChunk == 0 && mOffset == 0 && mChunks.size() > 1) {
+            size_t peak = mPeak;
+            releaseChunks();
+            addChunk(peak);
+            mPeak = 0;
+        }
+    }
+
+    void reset() { rewind({0, 0}); }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for (const auto& c : mChunks) total += c.size;
+        return total;
+    }
+
+    // One arena per thread
+    static ScratchArena& local() {
+        thread_local ScratchArena arena;
+        return arena;
+    }
+};
+
+// Routes every Matrix / Vector created in this scope to the thread's scratch arena,
+// and frees all of them at once when the scope ends. Anything that must outlive the
+// scope has to be created before it (or copied into such an object) by the caller.
+class ScratchScope {
+private:
+    ScratchArena& mArena;
+    ScratchArena::Mark mMark;
+    Allocator* mPrevious;
+
+public:
+    ScratchScope()
+    : mArena(ScratchArena::local()), mMark(mArena.mark()), mPrevious(Allocator::current()) {
+        Allocator::current() = &mArena;
+    }
+    ~ScratchScope() {
+        Allocator::current() = mPrevious;
+        mArena.rewind(mMark);
+    }
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+};
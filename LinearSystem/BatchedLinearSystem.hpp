@@ -0,0 +1,297 @@
+// BatchedLinearSystem.hpp
+#pragma once
+#include "Matrix.hpp"
+#include "Vector.hpp"
+#include "Parallel.hpp"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <stdexcept>
+
+// Many independent n x n systems of the same size, solved together.
+// Systems are grouped in blocks of kLanes and stored interleaved: element (i, j) of
+// every system in a block is contiguous, so each elimination step is a single loop
+// across kLanes systems that the compiler turns into SIMD. Blocks are spread over threads.
+class BatchedLinearSystem {
+public:
+    static const int kLanes = 8;
+    enum class Method { LU, Cholesky };
+
+private:
+    int mSize;
+    int mCount;
+    int mBlocks;
+    std::vector<double> mA;         // [block][row][col][lane]
+    std::vector<double> mb;         // [block][row][lane], overwritten by the solution
+
+    // solve() overwrites A with its factors and b with the solution, so every system remembers
+    // whether it holds input (Dirty), a solution (Solved) or the factors of a failed solve (Failed),
+    // and which method factorized it
+    enum class State : char { Dirty, Solved, Failed };
+    std::vector<State> mState;
+    std::vector<Method> mMethod;
+
+    double* blockA(int blk) { return mA.data() + static_cast<size_t>(blk) * mSize * mSize * kLanes; }
+    double* blockb(int blk) { return mb.data() + static_cast<size_t>(blk) * mSize * kLanes; }
+
+    double& bEntry(int k, int i) {
+        return blockb((k - 1) / kLanes)[(i - 1) * kLanes + (k - 1) % kLanes];
+    }
+
+    void checkIndex(int k) const {
+        if (k < 1 || k > mCount)
+            throw std::out_of_range("\n>> Error: System " + std::to_string(k) + " is out of bounds (1-based).");
+    }
+
+    // Gaussian elimination with partial pivoting, each lane picking its own pivot row
+    static void luBlock(int n, double* A, double* b, char* singular) {
+        const int L = kLanes;
+        auto a = [&](int i, int j) { return A + (static_cast<size_t>(i) * n + j) * L; };
+
+        for (int k = 0; k < n; ++k) {
+            int piv[L];
+            double best[L];
+            for (int l = 0; l < L; ++l) { piv[l] = k; best[l] = std::abs(a(k, k)[l]); }
+            for (int i = k + 1; i < n; ++i) {
+                const double* col = a(i, k);
+                for (int l = 0; l < L; ++l) {
+                    double v = std::abs(col[l]);
+                    if (v > best[l]) { best[l] = v; piv[l] = i; }
+                }
+            }
+
+            for (int l = 0; l < L; ++l) {
+                if (piv[l] != k) {
+                    for (int j = k; j < n; ++j) std::swap(a(k, j)[l], a(piv[l], j)[l]);
+                    std::swap(b[k * L + l], b[piv[l] * L + l]);
+                }
+                if (best[l] < 1e-12) { singular[l] = 1; a(k, k)[l] = 1.0; }
+            }
+
+            double inv[L];
+            for (int l = 0; l < L; ++l) inv[l] = 1.0 / a(k, k)[l];
+
+            for (int i = k + 1; i < n; ++i) {
+                double f[L];
+                double* rowI = a(i, 0);
+                const double* rowK = a(k, 0);
+                for (int l = 0; l < L; ++l) f[l] = rowI[k * L + l] * inv[l];
+                for (int j = k + 1; j < n; ++j)
+                    for (int l = 0; l < L; ++l) rowI[j * L + l] -= f[l] * rowK[j * L + l];
+                for (int l = 0; l < L; ++l) b[i * L + l] -= f[l] * b[k * L + l];
+            }
+        }
+
+        // Back substitution
+        for (int i = n - 1; i >= 0; --i) {
+            double x[L];
+            const double* rowI = a(i, 0);
+            for (int l = 0; l < L; ++l) x[l] = b[i * L + l];
+            for (int j = i + 1; j < n; ++j)
+                for (int l = 0; l < L; ++l) x[l] -= rowI[j * L + l] * b[j * L + l];
+            for (int l = 0; l < L; ++l) b[i * L + l] = x[l] / rowI[i * L + l];
+        }
+    }
+
+    // In-place Cholesky A = L L^T on the lower triangle, then two triangular solves
+    static void choleskyBlock(int n, double* A, double* b, char* singular) {
+        const int L = kLanes;
+        auto a = [&](int i, int j) { return A + (static_cast<size_t>(i) * n + j) * L; };
+
+        for (int j = 0; j < n; ++j) {
+            double d[L];
+            for (int l = 0; l < L; ++l) d[l] = a(j, j)[l];
+            for (int k = 0; k < j; ++k) {
+                const double* ljk = a(j, k);
+                for (int l = 0; l < L; ++l) d[l] -= ljk[l] * ljk[l];
+            }
+            double inv[L];
+            for (int l = 0; l < L; ++l) {
+                if (d[l] < 1e-12) { singular[l] = 1; d[l] = 1.0; }
+                a(j, j)[l] = std::sqrt(d[l]);
+                inv[l] = 1.0 / a(j, j)[l];
+            }
+            for (int i = j + 1; i < n; ++i) {
+                double s[L];
+                for (int l = 0; l < L; ++l) s[l] = a(i, j)[l];
+                for (int k = 0; k < j; ++k) {
+                    const double* lik = a(i, k);
+                    const double* ljk = a(j, k);
+                    for (int l = 0; l < L; ++l) s[l] -= lik[l] * ljk[l];
+                }
+                for (int l = 0; l < L; ++l) a(i, j)[l] = s[l] * inv[l];
+            }
+        }
+
+        // Forward: L y = b
+        for (int i = 0; i < n; ++i) {
+            double y[L];
+            for (int l = 0; l < L; ++l) y[l] = b[i * L + l];
+            for (int k = 0; k < i; ++k) {
+                const double* lik = a(i, k);
+                for (int l = 0; l < L; ++l) y[l] -= lik[l] * b[k * L + l];
+            }
+            for (int l = 0; l < L; ++l) b[i * L + l] = y[l] / a(i, i)[l];
+        }
+        // Backward: L^T x = y
+        for (int i = n - 1; i >= 0; --i) {
+            double x[L];
+            for (int l = 0; l < L; ++l) x[l] = b[i * L + l];
+            for (int k = i + 1; k < n; ++k) {
+                const double* lki = a(k, i);
+                for (int l = 0; l < L; ++l) x[l] -= lki[l] * b[k * L + l];
+            }
+            for (int l = 0; l < L; ++l) b[i * L + l] = x[l] / a(i, i)[l];
+        }
+    }
+
+public:
+    BatchedLinearSystem(int count, int size)
+    : mSize(size), mCount(count), mBlocks((count + kLanes - 1) / kLanes) {
+        if (count < 1 || size < 1)
+            throw std::invalid_argument("Batch must hold at least one system of size >= 1");
+        mA.assign(static_cast<size_t>(mBlocks) * mSize * mSize * kLanes, 0.0);
+        mb.assign(static_cast<size_t>(mBlocks) * mSize * kLanes, 0.0);
+        mState.assign(mCount, State::Dirty);
+        mMethod.assign(mCount, Method::LU);
+        // Unused lanes of the last block hold identity systems so they never hit a zero pivot
+        for (int k = mCount; k < mBlocks * kLanes; ++k)
+            for (int i = 0; i < mSize; ++i)
+                blockA(k / kLanes)[(static_cast<size_t>(i) * mSize + i) * kLanes + k % kLanes] = 1.0;
+    }
+
+    int count() const { return mCount; }
+    int size() const { return mSize; }
+
+    // True once every system has been factorized since it was last set
+    bool solved() const {
+        for (State st : mState)
+            if (st == State::Dirty) return false;
+        return true;
+    }
+
+    // True if system k has a solution; false while it is unsolved or if its solve failed
+    bool ok(int k) const {
+        checkIndex(k);
+        return mState[k - 1] == State::Solved;
+    }
+
+    // Systems whose last solve failed (singular, or not positive definite for Cholesky), 1-based
+    std::vector<int> failed() const {
+        std::vector<int> result;
+        for (int k = 0; k < mCount; ++k)
+            if (mState[k] == State::Failed) result.push_back(k + 1);
+        return result;
+    }
+
+    // Element access (1-based): system k, row i, column j. Writable, so the batch needs a new solve()
+    double& A(int k, int i, int j) {
+        checkIndex(k);
+        if (i < 1 || i > mSize || j < 1 || j > mSize)
+            throw std::out_of_range("\nError: The matrix index (" + std::to_string(i) + ", " + std::to_string(j) + ") is out of range.");
+        mState[k - 1] = State::Dirty;
+        return blockA((k - 1) / kLanes)[(static_cast<size_t>(i - 1) * mSize + (j - 1)) * kLanes + (k - 1) % kLanes];
+    }
+
+    double& b(int k, int i) {
+        checkIndex(k);
+        if (i < 1 || i > mSize)
+            throw std::out_of_range("\n>> Error: Index " + std::to_string(i) + " is out of bounds (1-based).");
+        mState[k - 1] = State::Dirty;
+        return bEntry(k, i);
+    }
+
+    // Scatter a square system A x = b into slot k
+    void setSystem(int k, const Matrix& A_k, const Vector& b_k) {
+        if (A_k.rows() != mSize || A_k.cols() != mSize || b_k.size() != mSize)
+            throw std::invalid_argument("Incompatible matrix/vector sizes");
+        for (int i = 1; i <= mSize; ++i) {
+            for (int j = 1; j <= mSize; ++j) A(k, i, j) = A_k(i, j);
+            b(k, i) = b_k(i);
+        }
+    }
+
+    // Scatter the ridge normal equations (A^T A + lambda I) x = A^T b into slot k; solve with Method::Cholesky
+    void setLeastSquares(int k, const Matrix& A_k, const Vector& b_k, double lambda = 0.0) {
+        if (A_k.cols() != mSize || A_k.rows() != b_k.size())
+            throw std::invalid_argument("Incompatible matrix/vector sizes");
+        for (int i = 1; i <= mSize; ++i) {
+            for (int j = 1; j <= i; ++j) {
+                double s = 0.0;
+                for (int r = 1; r <= A_k.rows(); ++r) s += A_k(r, i) * A_k(r, j);
+                A(k, i, j) = s;
+                A(k, j, i) = s;
+            }
+            A(k, i, i) += lambda;
+            double s = 0.0;
+            for (int r = 1; r <= A_k.rows(); ++r) s += A_k(r, i) * b_k(r);
+            b(k, i) = s;
+        }
+    }
+
+    // Factorize and solve, in place, every system set since the last solve. LU handles any
+    // nonsingular system, Cholesky requires symmetric positive definite ones and is about twice
+    // as fast. Systems left unchanged keep their solutions, so solving again without changes is
+    // a no-op; their factors cannot be re-solved with the other method, so that throws. A system
+    // that cannot be solved does not stop the others: see ok(k) and failed().
+    void solve(Method method = Method::LU) {
+        for (int k = 0; k < mCount; ++k) {
+            if (mState[k] != State::Dirty && mMethod[k] != method)
+                throw std::runtime_error("\nError: System " + std::to_string(k + 1)
+                    + " has already been factorized with the other method; set it again before solving.");
+        }
+        const int n = mSize;
+        const size_t laneA = static_cast<size_t>(n) * n;
+        Parallel::forChunks(mBlocks, [&](int begin, int end) {
+            std::vector<double> keep;
+            for (int blk = begin; blk < end; ++blk) {
+                int first = blk * kLanes, last = std::min(first + kLanes, mCount);
+                int dirty = 0;
+                for (int k = first; k < last; ++k) dirty += mState[k] == State::Dirty;
+                if (dirty == 0) continue;
+
+                // The kernels work on whole blocks: save the lanes that already hold a result
+                double* A = blockA(blk);
+                double* b = blockb(blk);
+                keep.resize((laneA + n) * (last - first - dirty));
+                double* saved = keep.data();
+                for (int k = first; k < last; ++k) {
+                    if (mState[k] == State::Dirty) continue;
+                    int l = k - first;
+                    for (size_t e = 0; e < laneA; ++e) *saved++ = A[e * kLanes + l];
+                    for (int i = 0; i < n; ++i) *saved++ = b[i * kLanes + l];
+                }
+
+                char singular[kLanes] = {};
+                if (method == Method::LU) luBlock(n, A, b, singular);
+                else choleskyBlock(n, A, b, singular);
+
+                saved = keep.data();
+                for (int k = first; k < last; ++k) {
+                    int l = k - first;
+                    if (mState[k] == State::Dirty) {
+                        mState[k] = singular[l] ? State::Failed : State::Solved;
+                        mMethod[k] = method;
+                        continue;
+                    }
+                    for (size_t e = 0; e < laneA; ++e) A[e * kLanes + l] = *saved++;
+                    for (int i = 0; i < n; ++i) b[i * kLanes + l] = *saved++;
+                }
+            }
+        });
+    }
+
+    // Solution of system k after solve()
+    Vector solution(int k) {
+        checkIndex(k);
+        if (mState[k - 1] == State::Dirty)
+            throw std::runtime_error("\nError: System " + std::to_string(k) + " has not been solved.");
+        if (mState[k - 1] == State::Failed)
+            throw std::runtime_error("\nError: System " + std::to_string(k) + " is "
+                + (mMethod[k - 1] == Method::LU ? "singular or near-singular." : "not positive definite."));
+        Vector x(mSize, 0.0);
+        for (int i = 1; i <= mSize; ++i) x(i) = bEntry(k, i);
+        return x;
+    }
+};
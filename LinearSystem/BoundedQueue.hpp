@@ -0,0 +1,91 @@
+// BoundedQueue.hpp
+#pragma once
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+
+// Blocking FIFO with a fixed capacity between two pipeline stages. push() blocks while the
+// queue is full, so a slow consumer throttles its producer (backpressure) instead of letting
+// memory grow; pop() blocks while it is empty. close() ends the stream: pending items can
+// still be popped, further pushes are refused.
+template <typename T>
+class BoundedQueue {
+public:
+    struct Stats {
+        long long items;            // pushed in total
+        size_t maxDepth;            // highest fill level seen
+        size_t capacity;
+        double pushWaitSeconds;     // producers blocked on a full queue
+        double popWaitSeconds;      // consumers blocked on an empty queue
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mNotFull;
+    std::condition_variable mNotEmpty;
+    std::deque<T> mItems;
+    size_t mCapacity;
+    bool mClosed = false;
+
+    long long mPushed = 0;
+    size_t mMaxDepth = 0;
+    double mPushWait = 0.0;
+    double mPopWait = 0.0;
+
+    static double since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+public:
+    explicit BoundedQueue(size_t capacity) : mCapacity(std::max<size_t>(1, capacity)) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // False if the queue was closed (the item is dropped)
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mItems.size() >= mCapacity && !mClosed) {
+            Clock::time_point start = Clock::now();
+            mNotFull.wait(lock, [&] { return mItems.size() < mCapacity || mClosed; });
+            mPushWait += since(start);
+        }
+        if (mClosed) return false;
+        mItems.push_back(std::move(item));
+        ++mPushed;
+        mMaxDepth = std::max(mMaxDepth, mItems.size());
+        mNotEmpty.notify_one();
+        return true;
+    }
+
+    // False once the queue is closed and drained
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mItems.empty() && !mClosed) {
+            Clock::time_point start = Clock::now();
+            mNotEmpty.wait(lock, [&] { return !mItems.empty() || mClosed; });
+            mPopWait += since(start);
+        }
+        if (mItems.empty()) return false;
+        item = std::move(mItems.front());
+        mItems.pop_front();
+        mNotFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mClosed = true;
+        mNotFull.notify_all();
+        mNotEmpty.notify_all();
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return {mPushed, mMaxDepth, mCapacity, mPushWait, mPopWait};
+    }
+};
@@ -0,0 +1,435 @@
+// FeaturePipeline.hpp
+#pragma once
+#include "Matrix.hpp"
+#include "Vector.hpp"
+#include "SymmetricMatrix.hpp"
+#include "FeatureStage.hpp"
+#include "KernelFeatures.hpp"
+#include "Parallel.hpp"
+#include <vector>
+#include <memory>
+#include <functional>
+#include <string>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+
+// Prepends a constant 1 column
+class InterceptStage : public FeatureStage {
+public:
+    std::string name() const override { return "intercept"; }
+    int outDim(int inDim) const override { return inDim + 1; }
+    void apply(const double* in, int inDim, double* out) const override {
+        out[0] = 1.0;
+        std::copy(in, in + inDim, out + 1);
+    }
+
+    bool affine() const override { return true; }
+    void affineMap(int inDim, double* A, double* c) const override {
+        c[0] = 1.0;
+        for (int j = 0; j < inDim; ++j) A[static_cast<size_t>(j + 1) * inDim + j] = 1.0;
+    }
+};
+
+// log(1 + x) on every column; inputs must be > -1
+class LogStage : public FeatureStage {
+public:
+    std::string name() const override { return "log"; }
+    int outDim(int inDim) const override { return inDim; }
+    void apply(const double* in, int inDim, double* out) const override {
+        for (int j = 0; j < inDim; ++j) {
+            if (in[j] <= -1.0) throw std::domain_error("\n>> Error: log stage needs values > -1, got " + std::to_string(in[j]));
+            out[j] = std::log1p(in[j]);
+        }
+    }
+};
+
+// (x - mean) / stddev per column, statistics from one Welford pass
+class ZScoreStage : public FeatureStage {
+private:
+    long long mCount = 0;
+    std::vector<double> mMean;
+    std::vector<double> mM2;
+    std::vector<double> mInvStd;
+
+public:
+    std::string name() const override { return "zscore"; }
+    int outDim(int inDim) const override { return inDim; }
+
+    void apply(const double* in, int inDim, double* out) const override {
+        if (static_cast<int>(mMean.size()) != inDim) throw std::runtime_error("\n>> Error: zscore stage used before fit.");
+        for (int j = 0; j < inDim; ++j) out[j] = (in[j] - mMean[j]) * mInvStd[j];
+    }
+
+    bool needsFit() const override { return true; }
+    void beginFit(int inDim) override {
+        mCount = 0;
+        mMean.assign(inDim, 0.0);
+        mM2.assign(inDim, 0.0);
+    }
+    void observe(const double* row) override {
+        ++mCount;
+        for (size_t j = 0; j < mMean.size(); ++j) {
+            double delta = row[j] - mMean[j];
+            mMean[j] += delta / mCount;
+            mM2[j] += delta * (row[j] - mMean[j]);
+        }
+    }
+    void endFit() override {
+        mInvStd.assign(mMean.size(), 1.0);
+        for (size_t j = 0; j < mMean.size(); ++j) {
+            double var = mCount > 1 ? mM2[j] / (mCount - 1) : 0.0;
+            if (var > 1e-24) mInvStd[j] = 1.0 / std::sqrt(var);   // constant columns are only centered
+        }
+    }
+
+    bool affine() const override { return true; }
+    void affineMap(int inDim, double* A, double* c) const override {
+        for (int j = 0; j < inDim; ++j) {
+            A[static_cast<size_t>(j) * inDim + j] = mInvStd[j];
+            c[j] = -mMean[j] * mInvStd[j];
+        }
+    }
+
+    void save(std::ostream& os) const override {
+        os << mMean.size();
+        for (size_t j = 0; j < mMean.size(); ++j) os << " " << mMean[j] << " " << mInvStd[j];
+    }
+    void load(std::istream& is) override {
+        size_t n;
+        if (!(is >> n)) return;
+        mMean.assign(n, 0.0);
+        mInvStd.assign(n, 1.0);
+        for (size_t j = 0; j < n; ++j) is >> mMean[j] >> mInvStd[j];
+    }
+};
+
+// Appends x^2 ... x^degree for every column
+class PolynomialStage : public FeatureStage {
+private:
+    int mDegree;
+
+public:
+    PolynomialStage(int degree = 2) : mDegree(degree) {
+        if (degree < 1) throw std::invalid_argument("Polynomial degree must be >= 1");
+    }
+    std::string name() const override { return "poly"; }
+    int outDim(int inDim) const override { return inDim * mDegree; }
+    void apply(const double* in, int inDim, double* out) const override {
+        std::copy(in, in + inDim, out);
+        for (int d = 2; d <= mDegree; ++d) {
+            double* prev = out + (d - 2) * inDim;
+            double* cur = out + (d - 1) * inDim;
+            for (int j = 0; j < inDim; ++j) cur[j] = prev[j] * in[j];
+        }
+    }
+    void save(std::ostream& os) const override { os << mDegree; }
+    void load(std::istream& is) override { is >> mDegree; }
+};
+
+// Appends x_i * x_j for every pair i < j
+class InteractionStage : public FeatureStage {
+public:
+    std::string name() const override { return "interact"; }
+    int outDim(int inDim) const override { return inDim + inDim * (inDim - 1) / 2; }
+    void apply(const double* in, int inDim, double* out) const override {
+        std::copy(in, in + inDim, out);
+        int k = inDim;
+        for (int i = 0; i < inDim; ++i)
+            for (int j = i + 1; j < inDim; ++j) out[k++] = in[i] * in[j];
+    }
+};
+
+// Ordered list of stages evaluated lazily, a cache-sized block of rows at a time.
+// The expanded rows only ever exist in a small scratch block, or directly in the
+// destination design matrix / normal-equation sums.
+class FeaturePipeline {
+private:
+    std::vector<std::unique_ptr<FeatureStage>> mStages;
+    int mInDim = -1;
+
+    // Rows per block so that a block of the widest stage stays around 32 KB
+    int blockRows() const {
+        int width = std::max(1, maxDim(static_cast<int>(mStages.size())));
+        return std::max(1, 4096 / width);
+    }
+
+    int maxDim(int nStages) const {
+        int d = mInDim, m = mInDim;
+        for (int s = 0; s < nStages; ++s) m = std::max(m, d = mStages[s]->outDim(d));
+        return m;
+    }
+
+    // Outputs at least this wide are expanded and accumulated in parallel
+    static const int kWideOutput = 64;
+
+    // Rows [r0, r1) through all stages into rows firstRow.. of Z (1-based); wide outputs on all threads
+    template <typename Rows>
+    void expandInto(const Rows& rows, int r0, int r1, Matrix& Z, int firstRow) const {
+        int nStages = static_cast<int>(mStages.size());
+        auto out = [&](int r) { return Z.row(firstRow + r - r0); };
+        if (outDim() < kWideOutput) {
+            runBlock(rows, r0, r1, nStages, out);
+            return;
+        }
+        Parallel::forChunks(r1 - r0, [&](int begin, int end) {
+            runBlock(rows, r0 + begin, r0 + end, nStages, out);
+        }, 64);
+    }
+
+    // Push one row through the first nStages stages into out, ping-ponging between two buffers
+    void runRow(const double* in, int nStages, double* bufA, double* bufB, double* out) const {
+        int d = mInDim;
+        for (int s = 0; s < nStages; ++s) {
+            double* dst = (s == nStages - 1) ? out : (s % 2 == 0 ? bufA : bufB);
+            mStages[s]->apply(in, d, dst);
+            in = dst;
+            d = mStages[s]->outDim(d);
+        }
+        if (nStages == 0) std::copy(in, in + d, out);
+    }
+
+    // Rows [r0, r1) through the first nStages stages; row r is written to out(r)
+    template <typename Rows, typename Out>
+    void runBlock(const Rows& rows, int r0, int r1, int nStages, Out out) const {
+        int width = maxDim(nStages);
+        std::vector<double> bufA(width), bufB(width);
+        for (int r = r0; r < r1; ++r) {
+            if (static_cast<int>(rows[r].size()) != mInDim)
+                throw std::invalid_argument("Inconsistent feature vector size in data.");
+            runRow(rows[r].data(), nStages, bufA.data(), bufB.data(), out(r));
+        }
+    }
+
+public:
+    FeaturePipeline() = default;
+    FeaturePipeline(FeaturePipeline&&) = default;
+    FeaturePipeline& operator=(FeaturePipeline&&) = default;
+
+    FeaturePipeline& add(std::unique_ptr<FeatureStage> stage) {
+        mStages.push_back(std::move(stage));
+        return *this;
+    }
+
+    template <typename Stage, typename... Args>
+    FeaturePipeline& add(Args&&... args) {
+        return add(std::unique_ptr<FeatureStage>(new Stage(std::forward<Args>(args)...)));
+    }
+
+    int inDim() const { return mInDim; }
+    int outDim() const {
+        if (mInDim < 0) throw std::runtime_error("\n>> Error: Feature pipeline has not been fitted.");
+        int d = mInDim;
+        for (const auto& s : mStages) d = s->outDim(d);
+        return d;
+    }
+
+    // Number of stages that need statistics, i.e. streaming passes made by fit()
+    int fitPasses() const {
+        int n = 0;
+        for (const auto& s : mStages) n += s->needsFit();
+        return n;
+    }
+
+    // True if every stage is affine once fitted (z-score, intercept), so z = T [x; 1]
+    bool affine() const {
+        for (const auto& s : mStages)
+            if (!s->affine()) return false;
+        return true;
+    }
+
+    // T of an affine fitted pipeline: outDim() x (inDim() + 1), row-major, z = T [x; 1]
+    std::vector<double> affineMap() const {
+        if (!affine()) throw std::runtime_error("\n>> Error: Feature pipeline is not affine.");
+        int d = mInDim, cols = mInDim + 1;
+        std::vector<double> T(static_cast<size_t>(d) * cols, 0.0);
+        for (int i = 0; i < d; ++i) T[static_cast<size_t>(i) * cols + i] = 1.0;
+        for (const auto& s : mStages) {
+            int out = s->outDim(d);
+            std::vector<double> A(static_cast<size_t>(out) * d, 0.0), c(out, 0.0);
+            s->affineMap(d, A.data(), c.data());
+            std::vector<double> next(static_cast<size_t>(out) * cols, 0.0);
+            for (int i = 0; i < out; ++i) {
+                double* row = next.data() + static_cast<size_t>(i) * cols;
+                for (int k = 0; k < d; ++k) {
+                    double a = A[static_cast<size_t>(i) * d + k];
+                    if (a == 0.0) continue;
+                    const double* src = T.data() + static_cast<size_t>(k) * cols;
+                    for (int j = 0; j < cols; ++j) row[j] += a * src[j];
+                }
+                row[cols - 1] += c[i];
+            }
+            T.swap(next);
+            d = out;
+        }
+        return T;
+    }
+
+    // Fit every stage that needs statistics, streaming the data once per such stage
+    template <typename Rows>
+    void fit(const Rows& rows) {
+        if (rows.empty()) throw std::invalid_argument("Cannot fit a feature pipeline on empty data.");
+        int n = static_cast<int>(rows.size());
+        int inDim = static_cast<int>(rows[0].size());
+        fitStreaming(inDim, [&](const std::function<void(const double*, int)>& observe) {
+            for (int r = 0; r < n; ++r) {
+                if (static_cast<int>(rows[r].size()) != inDim)
+                    throw std::invalid_argument("Inconsistent feature vector size in data.");
+                observe(rows[r].data(), 1);
+            }
+        });
+    }
+
+    // Fit from data that does not fit in memory. pass(observe) must replay all raw rows, in
+    // order, as calls observe(rows, count) on rows stored back to back; it runs once per stage
+    // that needs statistics, and not at all if no stage does.
+    template <typename Pass>
+    void fitStreaming(int inDim, Pass pass) {
+        if (inDim < 1) throw std::invalid_argument("Need at least one feature.");
+        mInDim = inDim;
+        int d = mInDim;
+        for (size_t s = 0; s < mStages.size(); ++s) {
+            mStages[s]->prepare(d);
+            if (mStages[s]->needsFit()) {
+                int nStages = static_cast<int>(s);
+                int width = maxDim(nStages);
+                std::vector<double> bufA(width), bufB(width), out(d);
+                long long seen = 0;
+                mStages[s]->beginFit(d);
+                pass(std::function<void(const double*, int)>([&](const double* rows, int count) {
+                    for (int r = 0; r < count; ++r) {
+                        runRow(rows + static_cast<size_t>(r) * mInDim, nStages, bufA.data(), bufB.data(), out.data());
+                        mStages[s]->observe(out.data());
+                    }
+                    seen += count;
+                }));
+                if (seen == 0) {
+                    mInDim = -1;
+                    throw std::invalid_argument("Cannot fit a feature pipeline on empty data.");
+                }
+                mStages[s]->endFit();
+            }
+            d = mStages[s]->outDim(d);
+        }
+    }
+
+    // Expanded design matrix, written row by row straight into the result
+    template <typename Rows>
+    Matrix transform(const Rows& rows) const {
+        int n = static_cast<int>(rows.size());
+        Matrix M(n, outDim(), "M");
+        expandInto(rows, 0, n, M, 1);
+        return M;
+    }
+
+    // Single row, for inference
+    void transformRow(const double* in, double* out) const {
+        int width = maxDim(static_cast<int>(mStages.size()));
+        std::vector<double> bufA(width), bufB(width);
+        runRow(in, static_cast<int>(mStages.size()), bufA.data(), bufB.data(), out);
+    }
+
+    // count raw rows stored back to back (row-major) into rows firstRow.. of Z (1-based)
+    void transformRows(const double* in, int count, Matrix& Z, int firstRow) const {
+        int width = maxDim(static_cast<int>(mStages.size()));
+        std::vector<double> bufA(width), bufB(width);
+        for (int i = 0; i < count; ++i)
+            runRow(in + static_cast<size_t>(i) * mInDim, static_cast<int>(mStages.size()),
+                   bufA.data(), bufB.data(), Z.row(firstRow + i));
+    }
+
+    // Same, into a row-major buffer of count x outDim() values
+    void transformRows(const double* in, int count, double* out) const {
+        int width = maxDim(static_cast<int>(mStages.size()));
+        int p = outDim();
+        std::vector<double> bufA(width), bufB(width);
+        for (int i = 0; i < count; ++i)
+            runRow(in + static_cast<size_t>(i) * mInDim, static_cast<int>(mStages.size()),
+                   bufA.data(), bufB.data(), out + static_cast<size_t>(i) * p);
+    }
+
+    // ATA += Z^T Z and ATb += Z^T y for count already expanded rows Z stored back to back
+    static void accumulateExpanded(const double* Z, int count, const double* targets, SymmetricMatrix& ATA, Vector& ATb) {
+        int p = ATA.size();
+        if (ATb.size() != p) throw std::invalid_argument("Incompatible matrix/vector sizes");
+        SymmetricMatrix::accumulateRows(ATA.data(), p, Z, count, 1.0);
+        double* atb = ATb.data();
+        for (int r = 0; r < count; ++r) {
+            const double* z = Z + static_cast<size_t>(r) * p;
+            for (int i = 0; i < p; ++i) atb[i] += z[i] * targets[r];
+        }
+    }
+
+    // ATA += Z^T Z and ATb += Z^T y for the expanded rows Z, one block at a time
+    template <typename Rows>
+    void accumulateNormal(const Rows& rows, const std::vector<double>& targets, SymmetricMatrix& ATA, Vector& ATb) const {
+        int n = static_cast<int>(rows.size());
+        int p = outDim();
+        if (static_cast<int>(targets.size()) != n) throw std::invalid_argument("Incompatible matrix/vector sizes");
+        if (ATA.size() != p || ATb.size() != p) throw std::invalid_argument("Incompatible matrix/vector sizes");
+
+        // Wide expansions (kernel features): O(p^2) per row dominates, so all threads expand a
+        // chunk of rows into a Matrix and SymmetricMatrix::rankUpdate adds it tile by tile
+        if (p >= kWideOutput) {
+            int chunk = std::max(256, (1 << 20) / p);   // about 8 MB of expanded rows
+            for (int r0 = 0; r0 < n; r0 += chunk) {
+                int r1 = std::min(n, r0 + chunk);
+                ScratchScope scratch;
+                Matrix Z(r1 - r0, p, "Z");
+                expandInto(rows, r0, r1, Z, 1);
+                ATA.rankUpdate(Z);
+                for (int r = r0; r < r1; ++r) {
+                    const double* z = Z.row(r - r0 + 1);
+                    for (int i = 0; i < p; ++i) ATb.data()[i] += z[i] * targets[r];
+                }
+            }
+            return;
+        }
+
+        std::vector<double> block;
+        int step = blockRows();
+        block.resize(static_cast<size_t>(step) * p);
+        for (int r0 = 0; r0 < n; r0 += step) {
+            int r1 = std::min(n, r0 + step);
+            runBlock(rows, r0, r1, static_cast<int>(mStages.size()),
+                     [&](int r) { return block.data() + static_cast<size_t>(r - r0) * p; });
+            accumulateExpanded(block.data(), r1 - r0, targets.data() + r0, ATA, ATb);
+        }
+    }
+
+    void save(std::ostream& os) const {
+        os << "pipeline " << mInDim << " " << mStages.size() << "\n";
+        for (const auto& s : mStages) {
+            os << s->name() << " ";
+            s->save(os);
+            os << "\n";
+        }
+    }
+
+    static FeaturePipeline load(std::istream& is) {
+        FeaturePipeline fp;
+        std::string tag;
+        size_t n;
+        if (!(is >> tag >> fp.mInDim >> n) || tag != "pipeline" || fp.mInDim < 1)
+            throw std::runtime_error("\n>> Error: Malformed feature pipeline.");
+        for (size_t i = 0; i < n; ++i) {
+            std::string name;
+            if (!(is >> name)) throw std::runtime_error("\n>> Error: Malformed feature pipeline: missing stages.");
+            std::unique_ptr<FeatureStage> stage;
+            if (name == "intercept") stage.reset(new InterceptStage());
+            else if (name == "log") stage.reset(new LogStage());
+            else if (name == "zscore") stage.reset(new ZScoreStage());
+            else if (name == "poly") stage.reset(new PolynomialStage());
+            else if (name == "interact") stage.reset(new InteractionStage());
+            else if (name == "rff") stage.reset(new RandomFourierStage());
+            else if (name == "nystrom") stage.reset(new NystromStage());
+            else throw std::runtime_error("\n>> Error: Unknown feature stage: " + name);
+            stage->load(is);
+            // A truncated or corrupted file must not leave default or partial parameters
+            if (!is) throw std::runtime_error("\n>> Error: Malformed parameters of feature stage: " + name);
+            fp.add(std::move(stage));
+        }
+        return fp;
+    }
+};
@@ -0,0 +1,33 @@
+// FeatureStage.hpp
+#pragma once
+#include <string>
+#include <iostream>
+
+// A stage maps one row of inDim values to outDim(inDim) values.
+// Stages that need statistics (e.g. z-score) see the data once through observe() during fit.
+class FeatureStage {
+public:
+    virtual ~FeatureStage() = default;
+
+    virtual std::string name() const = 0;
+    virtual int outDim(int inDim) const = 0;
+    virtual void apply(const double* in, int inDim, double* out) const = 0;
+
+    // Called for every stage with its input width when the pipeline is fitted, before any
+    // data is seen; for parameters that depend only on the width (e.g. random projections)
+    virtual void prepare(int /*inDim*/) {}
+
+    virtual bool needsFit() const { return false; }
+    virtual void beginFit(int /*inDim*/) {}
+    virtual void observe(const double* /*row*/) {}
+    virtual void endFit() {}
+
+    // Stages that map x to A x + c once fitted; affineMap fills the zeroed A (outDim x inDim,
+    // row-major) and c. Lets a whole affine pipeline be applied to sums of rows.
+    virtual bool affine() const { return false; }
+    virtual void affineMap(int /*inDim*/, double* /*A*/, double* /*c*/) const {}
+
+    // Fitted parameters, written after name() when a model is saved
+    virtual void save(std::ostream& /*os*/) const {}
+    virtual void load(std::istream& /*is*/) {}
+};
@@ -0,0 +1,250 @@
+// IncrementalLeastSquares.hpp
+#pragma once
+#include <vector>
+#include <cmath>
+#include <string>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include "Matrix.hpp"
+#include "Vector.hpp"
+#include "SymmetricMatrix.hpp"
+
+// Ridge least squares over a changing subset of the columns of X.
+// The full Gram matrix X^T X and X^T y are computed once; the Cholesky factor
+// L L^T = X_S^T X_S + lambda I of the active set S is then updated in O(p^2) when a
+// column is added or removed, instead of rebuilding and inverting A^T A every time.
+// Column indices are 1-based, as in Matrix.
+class IncrementalLeastSquares {
+private:
+    int mRows;
+    int mCandidates;
+    double mLambda;
+    SymmetricMatrix mG;         // X^T X over all candidate columns
+    std::vector<double> mc;     // X^T y
+    double myy;                 // y^T y
+
+    std::vector<int> mActive;   // 0-based candidate index of each factor row
+    std::vector<double> mL;     // lower factor, row-major with stride mCandidates
+    std::vector<double> mz;     // z = L^{-1} c_S, so the objective is y^T y - z^T z
+
+    double& L(int i, int j) { return mL[static_cast<size_t>(i) * mCandidates + j]; }
+    double L(int i, int j) const { return mL[static_cast<size_t>(i) * mCandidates + j]; }
+    int size() const { return static_cast<int>(mActive.size()); }
+
+    // Partial F statistic of a change `delta` of the objective: delta over the residual variance
+    // objective / (n - k) of the model with k columns. Infinite for an exact fit, 0 without
+    // degrees of freedom left.
+    double partialF(double delta, double objective, int k) const {
+        if (mRows - k <= 0) return 0.0;
+        if (objective <= 0.0) return std::numeric_limits<double>::infinity();
+        return delta / (objective / (mRows - k));
+    }
+
+    void checkColumn(int col) const {
+        if (col < 1 || col > mCandidates)
+            throw std::out_of_range("\n>> Error: Column " + std::to_string(col) + " is out of bounds (1-based).");
+    }
+
+    // l = L^{-1} g with g_i = G(active_i, j)
+    void solveColumn(int j, std::vector<double>& l) const {
+        int k = size();
+        l.resize(k);
+        for (int i = 0; i < k; ++i) {
+            double s = mG(mActive[i] + 1, j + 1);
+            for (int m = 0; m < i; ++m) s -= L(i, m) * l[m];
+            l[i] = s / L(i, i);
+        }
+    }
+
+    // New diagonal entry and z component if column j were appended
+    bool extension(int j, std::vector<double>& l, double& diag, double& zj) const {
+        solveColumn(j, l);
+        double d = mG(j + 1, j + 1) + mLambda;
+        double s = d;
+        for (double v : l) s -= v * v;
+        if (s <= 1e-12 * std::max(d, 1e-300)) return false;   // (numerically) in the span of S
+        diag = std::sqrt(s);
+        double r = mc[j];
+        for (size_t m = 0; m < l.size(); ++m) r -= l[m] * mz[m];
+        zj = r / diag;
+        return true;
+    }
+
+    // L33' L33'^T = L33 L33^T + x x^T for the trailing block starting at row `from`
+    void rankOneUpdate(int from, std::vector<double>& x) {
+        int k = size();
+        for (int i = from; i < k; ++i) {
+            double xi = x[i - from];
+            double r = std::hypot(L(i, i), xi);
+            double c = r / L(i, i), s = xi / L(i, i);
+            L(i, i) = r;
+            for (int m = i + 1; m < k; ++m) {
+                L(m, i) = (L(m, i) + s * x[m - from]) / c;
+                x[m - from] = c * x[m - from] - s * L(m, i);
+            }
+        }
+    }
+
+public:
+    IncrementalLeastSquares(const Matrix& X, const Vector& y, double lambda = 0.0)
+    : mRows(X.rows()), mCandidates(X.cols()), mLambda(lambda), mG(X.cols()), mc(X.cols(), 0.0), myy(y * y) {
+        if (X.rows() != y.size()) throw std::invalid_argument("Incompatible matrix/vector sizes");
+        mG.rankUpdate(X);
+        for (int r = 1; r <= X.rows(); ++r) {
+            const double* row = X.row(r);
+            double yr = y(r);
+            for (int j = 0; j < mCandidates; ++j) mc[j] += row[j] * yr;
+        }
+        mL.assign(static_cast<size_t>(mCandidates) * mCandidates, 0.0);
+    }
+
+    int candidates() const { return mCandidates; }
+
+    // Active columns (1-based) in the order they were added
+    std::vector<int> active() const {
+        std::vector<int> cols;
+        for (int j : mActive) cols.push_back(j + 1);
+        return cols;
+    }
+
+    bool isActive(int col) const {
+        return std::find(mActive.begin(), mActive.end(), col - 1) != mActive.end();
+    }
+
+    // Append a column to the model: one forward solve, O(p^2)
+    void addColumn(int col) {
+        checkColumn(col);
+        if (isActive(col)) throw std::invalid_argument("Column " + std::to_string(col) + " is already in the model");
+        std::vector<double> l;
+        double diag, zj;
+        if (!extension(col - 1, l, diag, zj))
+            throw std::runtime_error("\nError: Column " + std::to_string(col) + " is linearly dependent on the model.");
+        int k = size();
+        for (int m = 0; m < k; ++m) L(k, m) = l[m];
+        L(k, k) = diag;
+        mActive.push_back(col - 1);
+        mz.push_back(zj);
+    }
+
+    // Drop a column: delete its row/column of L and restore the trailing block with a
+    // rank-one Cholesky update, O(p^2)
+    void removeColumn(int col) {
+        checkColumn(col);
+        auto it = std::find(mActive.begin(), mActive.end(), col - 1);
+        if (it == mActive.end()) throw std::invalid_argument("Column " + std::to_string(col) + " is not in the model");
+        int q = static_cast<int>(it - mActive.begin());
+        int k = size();
+
+        // Old column q below the diagonal feeds the update
+        std::vector<double> x;
+        for (int i = q + 1; i < k; ++i) x.push_back(L(i, q));
+
+        // Shift rows up and columns left past q
+        for (int i = q; i < k - 1; ++i) {
+            for (int m = 0; m < q; ++m) L(i, m) = L(i + 1, m);
+            for (int m = q; m <= i; ++m) L(i, m) = L(i + 1, m + 1);
+        }
+        for (int m = 0; m < k; ++m) L(k - 1, m) = 0.0;
+        mActive.erase(it);
+        rankOneUpdate(q, x);
+
+        // z changes only from position q on: L33' z3' = c3 - L31 z1
+        mz.resize(k - 1);
+        for (int i = q; i < k - 1; ++i) {
+            double s = mc[mActive[i]];
+            for (int m = 0; m < i; ++m) s -= L(i, m) * mz[m];
+            mz[i] = s / L(i, i);
+        }
+    }
+
+    // Penalized residual ||y - X_S b||^2 + lambda ||b||^2 of the current model
+    double objective() const {
+        double zz = 0.0;
+        for (double v : mz) zz += v * v;
+        return myy - zz;
+    }
+
+    // Coefficients for all candidate columns (0 for inactive ones): b_S = L^{-T} z
+    Vector coefficients() const {
+        int k = size();
+        std::vector<double> b(mz);
+        for (int i = k - 1; i >= 0; --i) {
+            b[i] /= L(i, i);
+            for (int m = 0; m < i; ++m) b[m] -= L(i, m) * b[i];
+        }
+        Vector result(mCandidates, 0.0);
+        for (int i = 0; i < k; ++i) result(mActive[i] + 1) = b[i];
+        return result;
+    }
+
+    // Decrease of the objective if `col` were added (0 if it is dependent), without changing the model
+    double additionGain(int col) const {
+        checkColumn(col);
+        if (isActive(col)) return 0.0;
+        std::vector<double> l;
+        double diag, zj;
+        return extension(col - 1, l, diag, zj) ? zj * zj : 0.0;
+    }
+
+    // Increase of the objective if each active column were dropped, in active() order:
+    // b_j^2 / (M^{-1})_jj with M = X_S^T X_S + lambda I, from one inverse of L (O(p^3))
+    std::vector<double> removalLosses() const {
+        int k = size();
+        std::vector<double> diagInv(k, 0.0), e(k);
+        for (int j = 0; j < k; ++j) {
+            // column j of L^{-1}; (M^{-1})_jj = ||L^{-1} e_j||^2
+            std::fill(e.begin(), e.end(), 0.0);
+            e[j] = 1.0 / L(j, j);
+            for (int i = j + 1; i < k; ++i) {
+                double s = 0.0;
+                for (int m = j; m < i; ++m) s -= L(i, m) * e[m];
+                e[i] = s / L(i, i);
+            }
+            for (int i = j; i < k; ++i) diagInv[j] += e[i] * e[i];
+        }
+        Vector b = coefficients();
+        std::vector<double> loss(k);
+        for (int i = 0; i < k; ++i) {
+            double bi = b(mActive[i] + 1);
+            loss[i] = bi * bi / diagInv[i];
+        }
+        return loss;
+    }
+
+    // Greedily add the column with the largest gain while its partial F statistic (gain over the
+    // residual variance of the larger model) reaches fToEnter and fewer than maxColumns are
+    // active. The default 4 is about the 5% level of F(1, n - k) for moderate n, so columns that
+    // only fit noise stay out. Returns the columns added, in order.
+    std::vector<int> forwardStepwise(int maxColumns, double fToEnter = 4.0) {
+        std::vector<int> added;
+        while (size() < std::min(maxColumns, mCandidates)) {
+            int best = -1;
+            double bestGain = 0.0;
+            for (int col = 1; col <= mCandidates; ++col) {
+                double gain = additionGain(col);
+                if (gain > bestGain) { bestGain = gain; best = col; }
+            }
+            if (best < 0 || partialF(bestGain, objective() - bestGain, size() + 1) < fToEnter) break;
+            addColumn(best);
+            added.push_back(best);
+        }
+        return added;
+    }
+
+    // Repeatedly drop the column whose removal costs least while its partial F statistic (loss
+    // over the residual variance of the current model) is below fToRemove and more than
+    // minColumns remain. Returns the columns dropped.
+    std::vector<int> backwardElimination(int minColumns, double fToRemove = 4.0) {
+        std::vector<int> removed;
+        while (size() > std::max(minColumns, 0)) {
+            std::vector<double> loss = removalLosses();
+            int q = static_cast<int>(std::min_element(loss.begin(), loss.end()) - loss.begin());
+            if (partialF(loss[q], objective(), size()) >= fToRemove) break;
+            int col = mActive[q] + 1;
+            removeColumn(col);
+            removed.push_back(col);
+        }
+        return removed;
+    }
+};
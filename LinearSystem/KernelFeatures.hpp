@@ -0,0 +1,178 @@
+// KernelFeatures.hpp
+#pragma once
+#include <vector>
+#include <string>
+#include <cmath>
+#include <random>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <Eigen/Dense>
+#include "FeatureStage.hpp"
+#include "VectorKernels.hpp"
+
+// Explicit feature maps z(x) in R^D with z(x) . z(y) ~ k(x, y) = exp(-gamma |x - y|^2), the RBF
+// kernel. Ridge regression on z is approximate kernel ridge regression: the normal equations
+// are D x D, so fitting costs O(n D^2) instead of an n x n kernel matrix, and a prediction
+// needs D features instead of n kernel evaluations. Put a ZScoreStage in front so one gamma
+// fits all columns.
+
+// Random Fourier features (Rahimi & Recht): z_j(x) = sqrt(2/D) cos(w_j . x + b_j) with
+// w_j ~ N(0, 2 gamma I) and b_j ~ U[0, 2 pi). The frequencies depend only on the seed and the
+// input width, so fitting never streams data through this stage; save() writes them out in full.
+class RandomFourierStage : public FeatureStage {
+private:
+    int mDim;
+    double mGamma;
+    unsigned mSeed;
+    int mInDim = 0;
+    std::vector<double> mW;     // mDim x mInDim, row-major
+    std::vector<double> mB;
+
+public:
+    RandomFourierStage(int dim = 100, double gamma = 1.0, unsigned seed = 42)
+    : mDim(dim), mGamma(gamma), mSeed(seed) {
+        if (dim < 1) throw std::invalid_argument("Need at least one Fourier feature.");
+        if (!(gamma > 0.0)) throw std::invalid_argument("Kernel gamma must be > 0.");
+    }
+
+    std::string name() const override { return "rff"; }
+    int outDim(int /*inDim*/) const override { return mDim; }
+
+    void apply(const double* in, int inDim, double* out) const override {
+        if (inDim != mInDim) throw std::runtime_error("\n>> Error: rff stage used before fit.");
+        double scale = std::sqrt(2.0 / mDim);
+        for (int j = 0; j < mDim; ++j) {
+            const double* w = mW.data() + static_cast<size_t>(j) * mInDim;
+            double s = mB[j];
+            for (int k = 0; k < mInDim; ++k) s += w[k] * in[k];
+            out[j] = scale * std::cos(s);
+        }
+    }
+
+    // No statistics needed: the frequencies are drawn as soon as the input width is known
+    void prepare(int inDim) override {
+        if (inDim == mInDim) return;
+        mInDim = inDim;
+        std::mt19937 g(mSeed);
+        std::normal_distribution<double> N(0.0, std::sqrt(2.0 * mGamma));
+        std::uniform_real_distribution<double> U(0.0, 2.0 * std::acos(-1.0));
+        mW.resize(static_cast<size_t>(mDim) * mInDim);
+        mB.resize(mDim);
+        for (double& w : mW) w = N(g);
+        for (double& b : mB) b = U(g);
+    }
+
+    void save(std::ostream& os) const override {
+        os << mDim << " " << mGamma << " " << mSeed << " " << mInDim;
+        for (double w : mW) os << " " << w;
+        for (double b : mB) os << " " << b;
+    }
+    void load(std::istream& is) override {
+        if (!(is >> mDim >> mGamma >> mSeed >> mInDim) || mDim < 1 || mInDim < 1 || !(mGamma > 0.0))
+            throw std::runtime_error("\n>> Error: Malformed rff stage parameters.");
+        mW.resize(static_cast<size_t>(mDim) * mInDim);
+        mB.resize(mDim);
+        for (double& w : mW) is >> w;
+        for (double& b : mB) is >> b;
+    }
+};
+
+// Nystrom features: m landmark rows sampled from the data (reservoir sampling, one pass),
+// z(x) = K_mm^{-1/2} k(x, landmarks). Costs O(m d + m^2) per row. Directions of K_mm with
+// negligible eigenvalues (duplicate landmarks, fewer rows than m) give zero columns, so the
+// output width is always m; the ridge penalty sends their coefficients to zero. The projection
+// is kept here rather than folded into the model coefficients, so transform() returns the
+// features the model was fitted on and any stage may follow this one.
+class NystromStage : public FeatureStage {
+private:
+    int mDim;
+    double mGamma;
+    unsigned mSeed;
+    int mInDim = 0;
+    int mCount = 0;                     // landmarks kept (< mDim only for tiny data)
+    std::vector<double> mLandmarks;     // mCount x mInDim, row-major
+    std::vector<double> mProjection;    // mCount x mDim, row-major: z = P^T k
+    long long mSeen = 0;
+    std::mt19937 mRng;
+
+    double kernel(const double* a, const double* b) const {
+        double d2 = 0.0;
+        for (int k = 0; k < mInDim; ++k) {
+            double d = a[k] - b[k];
+            d2 += d * d;
+        }
+        return std::exp(-mGamma * d2);
+    }
+
+public:
+    NystromStage(int landmarks = 100, double gamma = 1.0, unsigned seed = 42)
+    : mDim(landmarks), mGamma(gamma), mSeed(seed) {
+        if (landmarks < 1) throw std::invalid_argument("Need at least one landmark.");
+        if (!(gamma > 0.0)) throw std::invalid_argument("Kernel gamma must be > 0.");
+    }
+
+    std::string name() const override { return "nystrom"; }
+    int outDim(int /*inDim*/) const override { return mDim; }
+
+    void apply(const double* in, int inDim, double* out) const override {
+        if (inDim != mInDim || mProjection.empty()) throw std::runtime_error("\n>> Error: nystrom stage used before fit.");
+        std::fill(out, out + mDim, 0.0);
+        for (int i = 0; i < mCount; ++i) {
+            double k = kernel(in, mLandmarks.data() + static_cast<size_t>(i) * mInDim);
+            const double* p = mProjection.data() + static_cast<size_t>(i) * mDim;
+            VectorKernels::axpy(k, p, out, out, mDim);
+        }
+    }
+
+    bool needsFit() const override { return true; }
+    void beginFit(int inDim) override {
+        mInDim = inDim;
+        mCount = 0;
+        mSeen = 0;
+        mLandmarks.assign(static_cast<size_t>(mDim) * inDim, 0.0);
+        mProjection.clear();
+        mRng.seed(mSeed);
+    }
+    void observe(const double* row) override {
+        long long slot = mSeen++;
+        if (slot >= mDim) slot = std::uniform_int_distribution<long long>(0, slot)(mRng);
+        if (slot < mDim) {
+            std::copy(row, row + mInDim, mLandmarks.begin() + static_cast<size_t>(slot) * mInDim);
+            mCount = std::max(mCount, static_cast<int>(slot) + 1);
+        }
+    }
+    void endFit() override {
+        if (mCount == 0) throw std::invalid_argument("Cannot fit a nystrom stage on empty data.");
+        mLandmarks.resize(static_cast<size_t>(mCount) * mInDim);
+        Eigen::MatrixXd K(mCount, mCount);
+        for (int i = 0; i < mCount; ++i)
+            for (int j = 0; j <= i; ++j)
+                K(i, j) = K(j, i) = kernel(mLandmarks.data() + static_cast<size_t>(i) * mInDim,
+                                           mLandmarks.data() + static_cast<size_t>(j) * mInDim);
+        // K^{-1/2} on the well-conditioned eigenspace, largest eigenvalues first
+        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(K);
+        const Eigen::VectorXd& values = eig.eigenvalues();
+        double cutoff = 1e-10 * std::max(values(mCount - 1), 0.0);
+        mProjection.assign(static_cast<size_t>(mCount) * mDim, 0.0);
+        for (int c = 0, e = mCount - 1; e >= 0 && values(e) > cutoff; ++c, --e) {
+            double s = 1.0 / std::sqrt(values(e));
+            for (int i = 0; i < mCount; ++i) mProjection[static_cast<size_t>(i) * mDim + c] = eig.eigenvectors()(i, e) * s;
+        }
+    }
+
+    void save(std::ostream& os) const override {
+        os << mDim << " " << mGamma << " " << mSeed << " " << mInDim << " " << mCount;
+        for (double v : mLandmarks) os << " " << v;
+        for (double v : mProjection) os << " " << v;
+    }
+    void load(std::istream& is) override {
+        if (!(is >> mDim >> mGamma >> mSeed >> mInDim >> mCount) || mDim < 1 || mInDim < 1
+            || mCount < 1 || mCount > mDim || !(mGamma > 0.0))
+            throw std::runtime_error("\n>> Error: Malformed nystrom stage parameters.");
+        mLandmarks.resize(static_cast<size_t>(mCount) * mInDim);
+        mProjection.resize(static_cast<size_t>(mCount) * mDim);
+        for (double& v : mLandmarks) is >> v;
+        for (double& v : mProjection) is >> v;
+    }
+};
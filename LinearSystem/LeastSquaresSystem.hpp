@@ -1,6 +1,7 @@
 // LeastSquaresSystem.hpp
 #pragma once
 #include "LinearSystem.hpp"
+#include "SymmetricMatrix.hpp"
 
 class LeastSquaresSystem : public LinearSystem {
 private:
@@ -11,13 +12,42 @@ public:
     : LinearSystem(A, b), lambda(lambda) {}
 
     Vector solve() override {
+        Vector x;   // one named result, so it is constructed in place (no move out of a caller's scope)
+        solve(x);
+        return x;
+    }; // Normal equations / QR / SVD by conditioning, or Tikhonov
+
+    // Same, into caller-owned storage. x keeps its allocator and buffer when it already has
+    // cols() entries, so repeated ridge solves make no heap call once the arena is warm.
+    void solve(Vector& x) {
         if (lambda == 0.0) {
-            return mpA->pseudoinverse() * (*mpb);
-        } else {
-            Matrix At = mpA->transpose();
-            Matrix ATA = At * (*mpA);
-            Matrix regularized = ATA + lambda * Matrix::identity(ATA.rows());
-            return regularized.inverse("reginv") * (At * (*mpb));
+            x = SolverPolicy::leastSquares(*mpA, *mpb);
+            return;
+        }
+        ScratchScope scratch;   // ATA and A^T b are freed together at the end of the block
+        SymmetricMatrix ATA(mpA->cols());
+        ATA.rankUpdate(*mpA);
+        x = solveNormal(ATA, (*mpb) * (*mpA), lambda);
+    }
+
+    // (A^T A + lambda I) x = A^T b from already accumulated A^T A and A^T b, by Cholesky
+    static Vector solveNormal(const SymmetricMatrix& ATA, const Vector& ATb, double lambda) {
+        Vector x(ATb.size(), 0.0);
+        {
+            ScratchScope scratch;
+            SymmetricMatrix regularized = ATA;
+            regularized.addDiagonal(lambda);
+            x = regularized.solve(ATb);
+        }
+        return x;
+    }
+
+    static Vector solveNormal(const Matrix& ATA, const Vector& ATb, double lambda) {
+        Vector x(ATb.size(), 0.0);
+        {
+            ScratchScope scratch;
+            x = solveNormal(SymmetricMatrix::fromLower(ATA), ATb, lambda);
         }
-    }; // Pseudo-inverse or Tikhonov
-};
\ No newline at end of file
+        return x;
+    }
+};
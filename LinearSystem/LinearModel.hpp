@@ -0,0 +1,83 @@
+// LinearModel.hpp
+#pragma once
+#include "FeaturePipeline.hpp"
+#include "LeastSquaresSystem.hpp"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+
+// Fitted feature transform + ridge coefficients, kept together so inference
+// applies exactly the transform the coefficients were learned on
+class LinearModel {
+private:
+    FeaturePipeline mPipeline;
+    Vector mCoef;
+
+public:
+    LinearModel() = default;
+    LinearModel(FeaturePipeline pipeline) : mPipeline(std::move(pipeline)) {}
+
+    FeaturePipeline& pipeline() { return mPipeline; }
+    const FeaturePipeline& pipeline() const { return mPipeline; }
+    const Vector& coefficients() const { return mCoef; }
+    void setCoefficients(const Vector& coef) { mCoef = coef; }
+
+    // Fit the transform, then solve the ridge normal equations accumulated from the expanded rows
+    template <typename Rows>
+    const Vector& fit(const Rows& rows, const std::vector<double>& targets, double lambda) {
+        mPipeline.fit(rows);
+        int p = mPipeline.outDim();
+        Vector coef(p, 0.0);
+        {
+            ScratchScope scratch;
+            SymmetricMatrix ATA(p);
+            Vector ATb(p, 0.0);
+            mPipeline.accumulateNormal(rows, targets, ATA, ATb);
+            coef = LeastSquaresSystem::solveNormal(ATA, ATb, lambda);
+        }
+        mCoef = coef;
+        return mCoef;
+    }
+
+    double predict(const std::vector<double>& row) const {
+        if (static_cast<int>(row.size()) != mPipeline.inDim())
+            throw std::invalid_argument("Inconsistent feature vector size in data.");
+        std::vector<double> z(mPipeline.outDim());
+        mPipeline.transformRow(row.data(), z.data());
+        double y = 0.0;
+        for (int j = 0; j < mCoef.size(); ++j) y += z[j] * mCoef(j + 1);
+        return y;
+    }
+
+    template <typename Rows>
+    Vector predict(const Rows& rows) const {
+        Matrix Z = mPipeline.transform(rows);
+        return Z * mCoef;
+    }
+
+    void save(const std::string& filename) const {
+        std::ofstream os(filename);
+        if (!os.is_open()) throw std::runtime_error("\n>> Error: Cannot write model file: " + filename);
+        os.precision(17);
+        mPipeline.save(os);
+        os << "coef " << mCoef.size();
+        for (int j = 1; j <= mCoef.size(); ++j) os << " " << mCoef(j);
+        os << "\n";
+    }
+
+    static LinearModel load(const std::string& filename) {
+        std::ifstream is(filename);
+        if (!is.is_open()) throw std::runtime_error("\n>> Error: Cannot open model file: " + filename);
+        LinearModel model(FeaturePipeline::load(is));
+        std::string tag;
+        int p;
+        if (!(is >> tag >> p) || tag != "coef" || p != model.mPipeline.outDim())
+            throw std::runtime_error("\n>> Error: Malformed model file: " + filename);
+        Vector coef(p, 0.0);
+        for (int j = 1; j <= p; ++j) is >> coef(j);
+        if (!is) throw std::runtime_error("\n>> Error: Malformed model file: " + filename);
+        model.mCoef = coef;
+        return model;
+    }
+};
@@ -2,6 +2,7 @@
 #pragma once
 #include "Matrix.hpp"
 #include "Vector.hpp"
+#include "SolverPolicy.hpp"
 #include <stdexcept>
 
 class LinearSystem {
@@ -14,6 +15,13 @@ protected:
     LinearSystem(const LinearSystem&) = delete;
     LinearSystem& operator=(const LinearSystem&) = delete;
 
+    // For systems whose matrix is not a full Matrix (mpA stays null)
+    LinearSystem(int size, Vector* b)
+    :  mSize(size), mpA(nullptr), mpb(b) {
+        if (size != b->size())
+            throw std::invalid_argument("Incompatible matrix/vector sizes");
+    }
+
 public:
     LinearSystem(Matrix* A, Vector* b)
     :  mSize(A->rows()), mpA(A), mpb(b) {
@@ -22,5 +30,5 @@ public:
     }
     virtual ~LinearSystem() = default;
 
-    virtual Vector solve() {return mpA->solve(*mpb);}; // Gaussian elimination
+    virtual Vector solve() {return SolverPolicy::solve(*mpA, *mpb);}; // Cholesky / LU / QR / CG / SVD, see SolverPolicy
 };
\ No newline at end of file
@@ -4,8 +4,10 @@
 #include <string>
 #include <stdexcept>
 #include <initializer_list>
+#include <algorithm>
 #include <Eigen/IterativeLinearSolvers>
 #include "Vector.hpp"
+#include "Allocator.hpp"
 
 extern bool debug;
 
@@ -25,38 +27,57 @@ private:
     int mNumCols;
     double** mData;
     std::string mName;
+    Allocator* mAlloc;
+
+    // One aligned block per matrix from the current allocator: [row pointers | row-major data]
+    static size_t blockBytes(int rows, int cols) {
+        return Allocator::roundUp(sizeof(double*) * rows) + sizeof(double) * rows * cols;
+    }
+
+    void allocate(int rows, int cols) {
+        mNumRows = rows;
+        mNumCols = cols;
+        if (rows <= 0 || cols <= 0) { mData = nullptr; return; }
+        char* block = static_cast<char*>(mAlloc->allocate(blockBytes(rows, cols)));
+        mData = reinterpret_cast<double**>(block);
+        double* data = reinterpret_cast<double*>(block + Allocator::roundUp(sizeof(double*) * rows));
+        for (int i = 0; i < rows; ++i) mData[i] = data + static_cast<size_t>(i) * cols;
+    }
+
+    void release() {
+        if (mData) mAlloc->deallocate(mData, blockBytes(mNumRows, mNumCols));
+        mData = nullptr;
+    }
+
+    // Fresh storage from mAlloc holding a copy of other's entries
+    void copyFrom(const Matrix& other) {
+        allocate(other.mNumRows, other.mNumCols);
+        if (mData) std::copy(other.mData[0], other.mData[0] + static_cast<size_t>(mNumRows) * mNumCols, mData[0]);
+    }
 
 public:
     Matrix(int row = 0, int col = 0, const std::string& name = "")
-    : mNumRows(row), mNumCols(col), mName(name) {
-        if (mNumRows > 0 && mNumCols > 0) {
-            mData = new double*[mNumRows];
-            for (int i = 0; i < mNumRows; ++i) {
-                mData[i] = new double[mNumCols]{};
-            }
-        } else {
-            mData = nullptr;
-        }
+    : mName(name), mAlloc(Allocator::current()) {
+        allocate(row, col);
+        if (mData) std::fill(mData[0], mData[0] + static_cast<size_t>(mNumRows) * mNumCols, 0.0);
         if (debug) std::cout << "\n>> Constructor: Matrix " << (mName.empty() ? "<unnamed>" : mName)
                             << " (" << mNumRows << "x" << mNumCols << ")\n";
     }
 
-    Matrix(std::initializer_list<std::initializer_list<double>> initList) {
-        mNumRows = initList.size();
-        mNumCols = initList.begin()->size();
-        
-        // Allocate memory
-        mData = new double*[mNumRows];
-        for (int i = 0; i < mNumRows; ++i) {
-            mData[i] = new double[mNumCols];
+    Matrix(std::initializer_list<std::initializer_list<double>> initList)
+    : mAlloc(Allocator::current()) {
+        for (const auto& rowList : initList) {
+            if (rowList.size() != initList.begin()->size()) {
+                throw std::invalid_argument("All rows must have the same number of columns.");
+            }
         }
 
+        // Allocate memory
+        allocate(static_cast<int>(initList.size()), static_cast<int>(initList.begin()->size()));
+
         // Copy values
         int row = 0;
         for (const auto& rowList : initList) {
-            if (rowList.size() != static_cast<size_t>(mNumCols)) {
-                throw std::invalid_argument("All rows must have the same number of columns.");
-            }
             int col = 0;
             for (double val : rowList) {
                 mData[row][col++] = val;
@@ -70,12 +91,11 @@ public:
     }
     
     Matrix(const std::string& name, std::initializer_list<std::initializer_list<double>> initList)
-    : mNumRows(initList.size()), mNumCols(initList.begin()->size()), mName(name) {
+    : mName(name), mAlloc(Allocator::current()) {
         // Allocate and copy data
-        mData = new double*[mNumRows];
+        allocate(static_cast<int>(initList.size()), static_cast<int>(initList.begin()->size()));
         int i = 0;
         for (const auto& rowList : initList) {
-            mData[i] = new double[mNumCols];
             std::copy(rowList.begin(), rowList.end(), mData[i]);
             ++i;
         }
@@ -92,40 +112,50 @@ public:
 
     // Copy constructor
     Matrix(const Matrix& other)
-    : mNumRows(other.mNumRows), mNumCols(other.mNumCols),
-      mName(other.mName.empty() ? "" : other.mName + "_copy") {
-        if (mNumRows > 0 && mNumCols > 0) {
-            mData = new double*[mNumRows];
-            for (int i = 0; i < mNumRows; i++) {
-                mData[i] = new double[mNumCols];
-                for (int j = 0; j < mNumCols; j++) {
-                    mData[i][j] = other.mData[i][j];
-                }
+    : mName(other.mName.empty() ? "" : other.mName + "_copy"), mAlloc(Allocator::current()) {
+        allocate(other.mNumRows, other.mNumCols);
+        for (int i = 0; i < mNumRows; i++) {
+            for (int j = 0; j < mNumCols; j++) {
+                mData[i][j] = other.mData[i][j];
             }
-        } else {
-            mData = nullptr;
         }
         if (debug) std::cout << "\n>> Copy Constructor: Matrix " << mName << "\n";
     }
 
-    // Move constructor
+    // Move constructor (a scratch-arena buffer is copied to the heap, since the new matrix may outlive the scope).
+    // Kept noexcept so std::vector<Matrix> grows by moving: only that arena copy allocates, and if
+    // it throws bad_alloc the program terminates.
     Matrix(Matrix&& other) noexcept
     : mNumRows(other.mNumRows), mNumCols(other.mNumCols),
-      mData(other.mData), mName(std::move(other.mName)) {
+      mData(other.mData), mName(std::move(other.mName)), mAlloc(Allocator::adoptable(other.mAlloc)) {
+        if (mAlloc != other.mAlloc) copyFrom(other);
         other.mData = nullptr;
         other.mNumRows = 0;
         other.mNumCols = 0;
         if (debug) std::cout << "\n>> Move Constructor: Matrix " << mName << " has been moved\n";
     }
 
+    // Move assignment; an arena buffer is copied into this matrix's own storage instead of adopted
+    // (noexcept as above: bad_alloc on that copy terminates)
     Matrix& operator=(Matrix&& other) noexcept {
         if (this != &other) {
+            if (other.mAlloc->scoped()) {
+                if (mNumRows != other.mNumRows || mNumCols != other.mNumCols || !mData) {
+                    release();
+                    copyFrom(other);
+                } else {
+                    std::copy(other.mData[0], other.mData[0] + static_cast<size_t>(mNumRows) * mNumCols, mData[0]);
+                }
+                mName = std::move(other.mName);
+                return *this;
+            }
+
             // Free old memory
-            for (int i = 0; i < mNumRows; ++i) delete[] mData[i];
-            delete[] mData;
+            release();
 
             // Transfer ownership
             mData = other.mData;
+            mAlloc = other.mAlloc;
             mNumRows = other.mNumRows;
             mNumCols = other.mNumCols;
             mName = std::move(other.mName);
@@ -141,10 +171,7 @@ public:
     // Destructor
     ~Matrix() {
         if (debug) std::cout << "\n>> Destructor: Matrix " << mName << " has been deleted\n";
-        if (mData) {
-            for (int i = 0; i < mNumRows; ++i) delete[] mData[i];
-            delete[] mData;
-        }
+        release();
     }
 
     // Access element (1-based) - mutable
@@ -161,15 +188,28 @@ public:
         return mData[row - 1][col - 1];
     }
     
+    // Raw pointer to a row (1-based) for kernels that fill or read a whole row at once
+    double* row(int i) {
+        if (i < 1 || i > mNumRows)
+            throw out_of_range("\nError: The matrix row " + to_string(i) + " is out of range.");
+        return mData[i - 1];
+    }
+
+    const double* row(int i) const {
+        if (i < 1 || i > mNumRows)
+            throw out_of_range("\nError: The matrix row " + to_string(i) + " is out of range.");
+        return mData[i - 1];
+    }
+
     // Access NumRows, NumCols
     int rows() const { return mNumRows; }
     int cols() const { return mNumCols; }
     std::pair<int, int> shape() const { return {mNumRows, mNumCols}; }
     bool isSymmetric() const {
         if (mNumRows != mNumCols) return false;
-        for (int i = 1; i <= mNumRows; ++i) {
-            for (int j = i + 1; j <= mNumCols; ++j) {
-                if (std::abs((*this)(i, j) - (*this)(j, i)) > 1e-9) return false;
+        for (int i = 0; i < mNumRows; ++i) {
+            for (int j = i + 1; j < mNumCols; ++j) {
+                if (std::abs(mData[i][j] - mData[j][i]) > 1e-9) return false;
             }
         }
         return true;
@@ -217,18 +257,24 @@ public:
     }
 
     // Vector multiplication
-    Vector operator*(const Vector& other) {
+    Vector operator*(const Vector& other) const {
         if (mNumCols != other.size()) throw std::runtime_error("Incompatible sizes.");
         Vector result(mNumRows, 0.0); // Create zero-vector
-        for (int i = 0; i < mNumRows; ++i)
-            for (int j = 0; j < mNumCols; ++j)
-                result(i + 1) += mData[i][j] * other(j + 1);
+        const double* x = other.data();
+        double* y = result.data();
+        for (int i = 0; i < mNumRows; ++i) {
+            const double* row = mData[i];
+            double sum = 0.0;
+            for (int j = 0; j < mNumCols; ++j) sum += row[j] * x[j];
+            y[i] = sum;
+        }
         return result;
     }
 
     // Determinant
     double det() const {
         DebugScope scope((mName.empty() ? "Matrix::det" : mName + "::det"));
+        ScratchScope scratch;   // the working copy lives in the thread's arena
         Matrix temp = *this;
         if (mNumRows != mNumCols) throw std::runtime_error("\nError: Cannot calculate the determinant of a non-square matrix.");
         int n = mNumCols;
@@ -267,6 +313,8 @@ public:
             return inv;
         }
 
+        Matrix result(n, n, name);
+        ScratchScope scratch;   // aug lives in the thread's arena, result was allocated before it
         Matrix aug(n, 2 * n, "aug");
         // Augment [A | I]
         for (int i = 0; i < n; ++i) {
@@ -303,7 +351,6 @@ public:
             }
         }
 
-        Matrix result(n, n, name);
         for (int i = 0; i < n; ++i)
             for (int j = 0; j < n; ++j)
                 result(i + 1, j + 1) = aug(i + 1, j + n + 1);
@@ -367,13 +414,9 @@ public:
 
     // Helper to load from Eigen matrix
     void fromEigen(const Eigen::MatrixXd& mat) {
-        for (int i = 0; i < mNumRows; ++i) delete[] mData[i];
-        delete[] mData;
-        mNumRows = mat.rows();
-        mNumCols = mat.cols();
-        mData = new double*[mNumRows];
+        release();
+        allocate(static_cast<int>(mat.rows()), static_cast<int>(mat.cols()));
         for (int i = 0; i < mNumRows; ++i) {
-            mData[i] = new double[mNumCols];
             for (int j = 0; j < mNumCols; ++j)
                 mData[i][j] = mat(i, j);
         }
@@ -391,11 +434,11 @@ public:
     }
 };
 
-Matrix operator*(const double& scalar, const Matrix& mat) {
+inline Matrix operator*(const double& scalar, const Matrix& mat) {
     return mat * scalar;
 }
 
-Vector operator*(const Vector& vec, const Matrix& mat) {
+inline Vector operator*(const Vector& vec, const Matrix& mat) {
     if (vec.size() != mat.rows()) {
         throw std::runtime_error("Incompatible sizes for vector * matrix multiplication.");
     }
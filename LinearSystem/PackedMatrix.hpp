@@ -0,0 +1,101 @@
+// PackedMatrix.hpp
+#pragma once
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include "Allocator.hpp"
+
+// Shared storage for SymmetricMatrix and TriangularMatrix: one n x n triangle packed by rows,
+// entry (i, j) with i >= j (0-based) at i * (i + 1) / 2 + j. Half the memory of a full Matrix.
+class PackedMatrix {
+protected:
+    int mSize;
+    double* mData;
+    Allocator* mAlloc;
+
+    static size_t packedSize(int n) { return static_cast<size_t>(n) * (n + 1) / 2; }
+    static size_t index(int i, int j) { return static_cast<size_t>(i) * (i + 1) / 2 + j; }
+
+    void allocate(int n) {
+        mSize = n;
+        mData = n > 0 ? static_cast<double*>(mAlloc->allocate(sizeof(double) * packedSize(n))) : nullptr;
+    }
+
+    void release() {
+        if (mData) mAlloc->deallocate(mData, sizeof(double) * packedSize(mSize));
+        mData = nullptr;
+    }
+
+    void checkIndex(int i, int j) const {
+        if (i < 1 || i > mSize || j < 1 || j > mSize)
+            throw std::out_of_range("\nError: The matrix index (" + std::to_string(i) + ", " + std::to_string(j) + ") is out of range.");
+    }
+
+    PackedMatrix(int n) : mAlloc(Allocator::current()) {
+        allocate(n);
+        std::fill(mData, mData + packedSize(n), 0.0);
+    }
+
+    PackedMatrix(const PackedMatrix& other) : mAlloc(Allocator::current()) {
+        allocate(other.mSize);
+        std::copy(other.mData, other.mData + packedSize(mSize), mData);
+    }
+
+    // A scratch-arena buffer is copied to the heap, since the new matrix may outlive the scope
+    // (noexcept like Matrix: bad_alloc on that copy terminates)
+    PackedMatrix(PackedMatrix&& other) noexcept
+    : mSize(other.mSize), mData(other.mData), mAlloc(Allocator::adoptable(other.mAlloc)) {
+        if (mAlloc != other.mAlloc) {
+            allocate(other.mSize);
+            std::copy(other.mData, other.mData + packedSize(mSize), mData);
+        }
+        other.mData = nullptr;
+        other.mSize = 0;
+    }
+
+    // Keeps this matrix's allocator, and its buffer when the sizes match
+    PackedMatrix& operator=(const PackedMatrix& other) {
+        if (this != &other) {
+            if (mSize != other.mSize) {
+                release();
+                allocate(other.mSize);
+            }
+            std::copy(other.mData, other.mData + packedSize(mSize), mData);
+        }
+        return *this;
+    }
+
+    // An arena buffer is copied into this matrix's own storage instead of adopted
+    PackedMatrix& operator=(PackedMatrix&& other) noexcept {
+        if (this != &other) {
+            if (other.mAlloc->scoped()) {
+                if (mSize != other.mSize || !mData) {
+                    release();
+                    allocate(other.mSize);
+                }
+                std::copy(other.mData, other.mData + packedSize(mSize), mData);
+                return *this;
+            }
+            release();
+            mSize = other.mSize;
+            mData = other.mData;
+            mAlloc = other.mAlloc;
+            other.mData = nullptr;
+            other.mSize = 0;
+        }
+        return *this;
+    }
+
+    ~PackedMatrix() { release(); }
+
+public:
+    int size() const { return mSize; }
+    int rows() const { return mSize; }
+    int cols() const { return mSize; }
+    std::pair<int, int> shape() const { return {mSize, mSize}; }
+
+    // Packed triangle, for kernels
+    double* data() { return mData; }
+    const double* data() const { return mData; }
+};
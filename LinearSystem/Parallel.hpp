@@ -0,0 +1,196 @@
+// Parallel.hpp
+#pragma once
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+
+class Parallel {
+private:
+    static int& threadOverride() {
+        static int n = 0;
+        return n;
+    }
+
+    static bool& reproducibleFlag() {
+        static bool on = false;
+        return on;
+    }
+
+    // Worker threads kept between calls: launch() hands them a task instead of creating
+    // threads every time, and their thread_local state (scratch arenas) stays warm. One task
+    // runs at a time; a launch that finds the pool busy (another caller, or a nested launch
+    // from inside a task) starts its own threads instead.
+    class Pool {
+    private:
+        std::mutex mMutex;
+        std::condition_variable mWake;
+        std::condition_variable mDone;
+        std::vector<std::thread> mWorkers;
+        std::mutex mBusy;
+        void (*mInvoke)(void*, int) = nullptr;
+        void* mTask = nullptr;
+        long long mGeneration = 0;
+        int mActive = 0;        // workers 1..mActive take part in the current task
+        int mPending = 0;
+        bool mStop = false;
+
+        void work(int id) {
+            long long seen = 0;
+            std::unique_lock<std::mutex> lock(mMutex);
+            while (true) {
+                mWake.wait(lock, [&] { return mStop || mGeneration != seen; });
+                if (mStop) return;
+                seen = mGeneration;
+                if (id > mActive) continue;
+                void (*invoke)(void*, int) = mInvoke;
+                void* task = mTask;
+                lock.unlock();
+                invoke(task, id);
+                lock.lock();
+                if (--mPending == 0) mDone.notify_one();
+            }
+        }
+
+    public:
+        ~Pool() {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mStop = true;
+            }
+            mWake.notify_all();
+            for (auto& w : mWorkers) w.join();
+        }
+
+        // invoke(task, t) for t in [0, nThreads), t = 0 on the caller; false if the pool is busy
+        bool run(int nThreads, void (*invoke)(void*, int), void* task) {
+            std::unique_lock<std::mutex> busy(mBusy, std::try_to_lock);
+            if (!busy.owns_lock()) return false;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                while (static_cast<int>(mWorkers.size()) < nThreads - 1) {
+                    int id = static_cast<int>(mWorkers.size()) + 1;
+                    mWorkers.emplace_back([this, id] { work(id); });
+                }
+                mInvoke = invoke;
+                mTask = task;
+                mActive = mPending = nThreads - 1;
+                ++mGeneration;
+            }
+            mWake.notify_all();
+            invoke(task, 0);
+            std::unique_lock<std::mutex> lock(mMutex);
+            mDone.wait(lock, [&] { return mPending == 0; });
+            return true;
+        }
+    };
+
+    static Pool& pool() {
+        static Pool p;
+        return p;
+    }
+
+    // Launch fn(t) on nThreads threads (t = 0 runs on the calling thread) and rethrow the first error
+    template <typename Fn>
+    static void launch(int nThreads, Fn&& fn) {
+        if (nThreads <= 1) { fn(0); return; }
+        std::vector<std::exception_ptr> errors(nThreads);
+        auto guarded = [&fn, &errors](int t) {
+            try { fn(t); } catch (...) { errors[t] = std::current_exception(); }
+        };
+        using Guarded = decltype(guarded);
+        auto invoke = [](void* task, int t) { (*static_cast<Guarded*>(task))(t); };
+        if (!pool().run(nThreads, invoke, &guarded)) {
+            std::vector<std::thread> workers;
+            workers.reserve(nThreads - 1);
+            for (int t = 1; t < nThreads; ++t) workers.emplace_back(guarded, t);
+            guarded(0);
+            for (auto& w : workers) w.join();
+        }
+        for (auto& e : errors)
+            if (e) std::rethrow_exception(e);
+    }
+
+public:
+    // Number of threads used by the parallel kernels (0 = use all hardware threads)
+    static void setThreads(int n) { threadOverride() = n; }
+
+    static int threads() {
+        int n = threadOverride();
+        if (n <= 0) n = static_cast<int>(std::thread::hardware_concurrency());
+        return n > 0 ? n : 1;
+    }
+
+    // Call fn(begin, end) on contiguous slices of [0, count), one slice per thread
+    template <typename Fn>
+    static void forChunks(int count, Fn fn, int minChunk = 1) {
+        if (count <= 0) return;
+        int nThreads = std::min(threads(), std::max(1, count / std::max(1, minChunk)));
+        launch(nThreads, [&](int t) {
+            int begin = static_cast<int>(static_cast<long long>(count) * t / nThreads);
+            int end = static_cast<int>(static_cast<long long>(count) * (t + 1) / nThreads);
+            if (begin < end) fn(begin, end);
+        });
+    }
+
+    // Reproducible reductions: a sum is split into fixed slices that depend only on the problem
+    // size and the partials are combined in a fixed pairwise order, so the result is bitwise
+    // identical for any thread count. Off by default: one partial per thread, summed in order.
+    static void setReproducible(bool on) { reproducibleFlag() = on; }
+    static bool reproducible() { return reproducibleFlag(); }
+
+    // Number of partials reduceSlices uses for count items
+    static int sliceCount(int count, int blockSize, int maxSlices = 1 << 30) {
+        if (count <= 0) return 0;
+        int slices = reproducible() ? (count + blockSize - 1) / blockSize
+                                    : std::min(threads(), std::max(1, count / blockSize));
+        return std::max(1, std::min(slices, maxSlices));
+    }
+
+    // Run fn(slice, begin, end) on sliceCount(...) contiguous slices of [0, count) in parallel
+    template <typename Fn>
+    static void reduceSlices(int count, int blockSize, int maxSlices, Fn fn) {
+        int slices = sliceCount(count, blockSize, maxSlices);
+        forChunks(slices, [&](int s0, int s1) {
+            for (int s = s0; s < s1; ++s)
+                fn(s, static_cast<int>(static_cast<long long>(count) * s / slices),
+                      static_cast<int>(static_cast<long long>(count) * (s + 1) / slices));
+        });
+    }
+
+    // Fixed pairwise tree over n partials: add(i, j) adds partial j into partial i; the total ends in 0
+    template <typename Add>
+    static void pairwise(int n, Add add) {
+        for (int w = 1; w < n; w *= 2)
+            for (int i = 0; i + w < n; i += 2 * w) add(i, i + w);
+    }
+
+    // Sum of fn(begin, end) over slices of [0, count)
+    template <typename Fn>
+    static double sum(int count, Fn fn, int blockSize = 1 << 14) {
+        int slices = sliceCount(count, blockSize);
+        if (slices <= 1) return count > 0 ? fn(0, count) : 0.0;
+        std::vector<double> partial(slices);
+        reduceSlices(count, blockSize, slices, [&](int s, int begin, int end) { partial[s] = fn(begin, end); });
+        if (reproducible()) {
+            pairwise(slices, [&](int i, int j) { partial[i] += partial[j]; });
+            return partial[0];
+        }
+        double total = 0.0;
+        for (double v : partial) total += v;
+        return total;
+    }
+
+    // Call fn(i) for every i in [0, count), handing out indices dynamically
+    template <typename Fn>
+    static void forEach(int count, Fn fn) {
+        if (count <= 0) return;
+        std::atomic<int> next(0);
+        launch(std::min(threads(), count), [&](int) {
+            for (int i = next++; i < count; i = next++) fn(i);
+        });
+    }
+};
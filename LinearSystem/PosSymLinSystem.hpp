@@ -1,15 +1,24 @@
 // PosSymLinSystem.hpp
 #pragma once
 #include "LinearSystem.hpp"
+#include "SymmetricMatrix.hpp"
 
 class PosSymLinSystem : public LinearSystem {
+private:
+    SymmetricMatrix* mpS = nullptr;
+
 public:
     PosSymLinSystem(Matrix* A, Vector* b)
     : LinearSystem(A, b) {
         if (!A->isSymmetric()) throw std::invalid_argument("Matrix is not symmetric");
     }
 
+    // Packed symmetric matrix: symmetric by type, no check needed
+    PosSymLinSystem(SymmetricMatrix* S, Vector* b)
+    : LinearSystem(S->size(), b), mpS(S) {}
+
     Vector solve() override {
-        return mpA->conjugateGradient(*mpb);
-    }; // Conjugate Gradient
+        if (mpS) return SolverPolicy::solve(*mpS, *mpb);
+        return SolverPolicy::solveSymmetric(*mpA, *mpb);   // checked in the constructor
+    }; // Cholesky, or CG when large and sparse
 };
\ No newline at end of file
@@ -0,0 +1,200 @@
+// Resampling.hpp
+#pragma once
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include "Matrix.hpp"
+#include "Vector.hpp"
+#include "SymmetricMatrix.hpp"
+#include "Allocator.hpp"
+#include "Parallel.hpp"
+
+// Confidence interval around a point estimate
+struct Interval {
+    double lower;
+    double estimate;
+    double upper;
+};
+
+struct ResamplingResult {
+    std::vector<Interval> coef;     // one per column of A
+    Interval rmse;
+    int resamples;
+    int skipped;                    // resamples whose fit was singular (left out of the intervals)
+};
+
+// Bootstrap / jackknife for ridge regression coefficients.
+// A resample never copies rows: it is a vector of per-row weights (bootstrap counts,
+// or leave-one-out), and its Gram matrix is accumulated as sum_i w_i a_i a_i^T.
+// Resample r draws from its own RNG stream seeded from (seed, r), so results do not
+// depend on the number of threads. A resample whose Gram matrix is singular or numerically
+// singular (possible with lambda = 0, e.g. when it misses the only row that uses some column,
+// or that keeps some column independent of the others) is recorded as NaN
+// and left out of the intervals instead of aborting the run.
+class Resampling {
+private:
+    const Matrix& mA;
+    const Vector& mb;
+    double mLambda;
+
+    // SplitMix64: decorrelated per-resample seeds from one user seed
+    static uint64_t streamSeed(uint64_t seed, uint64_t stream) {
+        uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (stream + 1);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Weighted ridge fit; writes the coefficients and returns the RMSE over the rows with
+    // weight 0 (out-of-bag) if oob is set, else the weighted in-sample RMSE
+    double fitWeighted(const std::vector<double>& w, bool oob, double* coef) const {
+        int n = mA.rows(), p = mA.cols();
+        ScratchScope scratch;
+        SymmetricMatrix G(p);
+        Vector ATb(p, 0.0);
+        for (int r = 0; r < n; ++r) {
+            if (w[r] == 0.0) continue;
+            const double* a = mA.row(r + 1);
+            G.rankOneUpdate(a, w[r]);
+            double wb = w[r] * mb(r + 1);
+            for (int j = 0; j < p; ++j) ATb.data()[j] += wb * a[j];
+        }
+        G.addDiagonal(mLambda);
+        // Round-off can leave a tiny positive pivot where the resample is singular, and the
+        // fit would then be huge: a pivot at or below n * eps of its diagonal counts as zero
+        TriangularMatrix L = G.cholesky();
+        const double tolerance = n * std::numeric_limits<double>::epsilon();
+        for (int j = 1; j <= p; ++j)
+            if (L(j, j) * L(j, j) <= tolerance * G(j, j))
+                throw std::runtime_error("\nError: Matrix is numerically singular.");
+        Vector x = L.transposeSolve(L.solve(ATb));
+        std::copy(x.data(), x.data() + p, coef);
+
+        double sumSq = 0.0, count = 0.0;
+        for (int r = 0; r < n; ++r) {
+            double weight = oob ? (w[r] == 0.0 ? 1.0 : 0.0) : w[r];
+            if (weight == 0.0) continue;
+            const double* a = mA.row(r + 1);
+            double pred = 0.0;
+            for (int j = 0; j < p; ++j) pred += a[j] * coef[j];
+            double diff = pred - mb(r + 1);
+            sumSq += weight * diff * diff;
+            count += weight;
+        }
+        return count > 0.0 ? std::sqrt(sumSq / count) : std::nan("");
+    }
+
+    // fitWeighted, or NaN coefficients and RMSE if the resample cannot be solved
+    double fitOrSkip(const std::vector<double>& w, bool oob, double* coef) const {
+        try {
+            return fitWeighted(w, oob, coef);
+        } catch (const std::runtime_error&) {
+            std::fill(coef, coef + mA.cols(), std::nan(""));
+            return std::nan("");
+        }
+    }
+
+    // Linear-interpolated quantile of sorted values
+    static double quantile(const std::vector<double>& sorted, double q) {
+        if (sorted.empty()) return std::nan("");
+        double pos = q * (sorted.size() - 1);
+        size_t lo = static_cast<size_t>(std::floor(pos));
+        size_t hi = std::min(lo + 1, sorted.size() - 1);
+        return sorted[lo] + (pos - lo) * (sorted[hi] - sorted[lo]);
+    }
+
+    static Interval percentile(std::vector<double> values, double estimate, double confidence) {
+        values.erase(std::remove_if(values.begin(), values.end(), [](double v) { return std::isnan(v); }), values.end());
+        std::sort(values.begin(), values.end());
+        double tail = (1.0 - confidence) / 2.0;
+        return {quantile(values, tail), estimate, quantile(values, 1.0 - tail)};
+    }
+
+    // estimate +- z * jackknife standard error (over the fits that could be solved)
+    static Interval jackknifeInterval(std::vector<double> values, double estimate, double confidence) {
+        values.erase(std::remove_if(values.begin(), values.end(), [](double v) { return std::isnan(v); }), values.end());
+        double n = static_cast<double>(values.size());
+        double mean = 0.0;
+        for (double v : values) mean += v / n;
+        double ss = 0.0;
+        for (double v : values) ss += (v - mean) * (v - mean);
+        double se = std::sqrt((n - 1.0) / n * ss);
+        // Two-sided normal quantile by bisection on erf
+        double target = confidence, lo = 0.0, hi = 10.0;
+        for (int it = 0; it < 100; ++it) {
+            double mid = 0.5 * (lo + hi);
+            if (std::erf(mid / std::sqrt(2.0)) < target) lo = mid; else hi = mid;
+        }
+        double z = 0.5 * (lo + hi);
+        return {estimate - z * se, estimate, estimate + z * se};
+    }
+
+    ResamplingResult summarize(const std::vector<double>& coefs, const std::vector<double>& rmse,
+                               int resamples, double confidence, bool jackknife) const {
+        int p = mA.cols();
+        std::vector<double> full(p);
+        double fullRmse = fitWeighted(std::vector<double>(mA.rows(), 1.0), false, full.data());
+
+        ResamplingResult result;
+        result.resamples = resamples;
+        result.skipped = 0;
+        for (int r = 0; r < resamples; ++r)
+            if (std::isnan(coefs[static_cast<size_t>(r) * p])) ++result.skipped;
+        std::vector<double> column(resamples);
+        for (int j = 0; j < p; ++j) {
+            for (int r = 0; r < resamples; ++r) column[r] = coefs[static_cast<size_t>(r) * p + j];
+            result.coef.push_back(jackknife ? jackknifeInterval(column, full[j], confidence)
+                                            : percentile(column, full[j], confidence));
+        }
+        result.rmse = jackknife ? jackknifeInterval(rmse, fullRmse, confidence)
+                                : percentile(rmse, fullRmse, confidence);
+        return result;
+    }
+
+public:
+    Resampling(const Matrix& A, const Vector& b, double lambda = 0.0)
+    : mA(A), mb(b), mLambda(lambda) {
+        if (A.rows() != b.size()) throw std::invalid_argument("Incompatible matrix/vector sizes");
+    }
+
+    // Percentile intervals from `resamples` bootstrap fits; the RMSE is measured out-of-bag
+    ResamplingResult bootstrap(int resamples, uint64_t seed, double confidence = 0.95) const {
+        if (resamples < 1) throw std::invalid_argument("Need at least one resample");
+        int n = mA.rows(), p = mA.cols();
+        std::vector<double> coefs(static_cast<size_t>(resamples) * p);
+        std::vector<double> rmse(resamples);
+
+        Parallel::forChunks(resamples, [&](int begin, int end) {
+            std::vector<double> w(n);
+            for (int r = begin; r < end; ++r) {
+                std::mt19937_64 rng(streamSeed(seed, r));
+                std::uniform_int_distribution<int> pick(0, n - 1);
+                std::fill(w.begin(), w.end(), 0.0);
+                for (int i = 0; i < n; ++i) w[pick(rng)] += 1.0;
+                rmse[r] = fitOrSkip(w, true, coefs.data() + static_cast<size_t>(r) * p);
+            }
+        });
+        return summarize(coefs, rmse, resamples, confidence, false);
+    }
+
+    // Leave-one-out fits; intervals are estimate +- z * jackknife standard error
+    ResamplingResult jackknife(double confidence = 0.95) const {
+        int n = mA.rows(), p = mA.cols();
+        std::vector<double> coefs(static_cast<size_t>(n) * p);
+        std::vector<double> rmse(n);
+
+        Parallel::forChunks(n, [&](int begin, int end) {
+            std::vector<double> w(n, 1.0);
+            for (int r = begin; r < end; ++r) {
+                w[r] = 0.0;
+                rmse[r] = fitOrSkip(w, false, coefs.data() + static_cast<size_t>(r) * p);
+                w[r] = 1.0;
+            }
+        });
+        return summarize(coefs, rmse, n, confidence, true);
+    }
+};
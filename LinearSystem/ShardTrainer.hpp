@@ -0,0 +1,399 @@
+// ShardTrainer.hpp
+#pragma once
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <functional>
+#include <exception>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include "BoundedQueue.hpp"
+#include "FeaturePipeline.hpp"
+#include "LinearModel.hpp"
+
+// Per-stage counters of one training run
+struct StageStats {
+    std::string name;
+    long long batches = 0;
+    long long rows = 0;
+    double busySeconds = 0.0;       // doing the stage's own work
+    double inputWaitSeconds = 0.0;  // starved: waiting for the previous stage
+    double outputWaitSeconds = 0.0; // backpressure: blocked on a full queue to the next stage
+
+    double rowsPerSecond() const { return busySeconds > 0.0 ? rows / busySeconds : 0.0; }
+};
+
+struct TrainingReport {
+    std::vector<StageStats> stages;                 // parse, transform, accumulate, solve
+    std::vector<size_t> queueMaxDepth;              // parse->transform, transform->accumulate
+    size_t queueCapacity = 0;
+    int shards = 0;
+    long long rows = 0;
+    int fitPasses = 0;                              // extra passes over the shards to fit the pipeline
+    double fitSeconds = 0.0;
+    bool fitInTrainingPass = false;                 // affine pipeline fitted during the training pass
+    double totalSeconds = 0.0;
+    bool pipelined = false;
+
+    double slowestStageSeconds() const {
+        double m = 0.0;
+        for (const auto& s : stages) m = std::max(m, s.busySeconds);
+        return m;
+    }
+
+    void print(std::ostream& os) const {
+        os << (pipelined ? "Pipelined" : "Serial") << ": " << rows << " rows from " << shards << " shards in "
+           << totalSeconds << " s (slowest stage " << slowestStageSeconds() << " s)\n";
+        if (fitInTrainingPass) os << "  fit: in the training pass (affine pipeline)\n";
+        if (fitPasses > 0) os << "  fit: " << fitPasses << " extra pass(es) over the shards in " << fitSeconds << " s\n";
+        os << "  " << std::left << std::setw(11) << "stage" << std::right << std::setw(9) << "batches"
+           << std::setw(12) << "busy s" << std::setw(14) << "rows/s" << std::setw(12) << "starved s" << std::setw(12) << "blocked s" << "\n";
+        for (const auto& s : stages)
+            os << "  " << std::left << std::setw(11) << s.name << std::right << std::setw(9) << s.batches
+               << std::setw(12) << s.busySeconds << std::setw(14) << s.rowsPerSecond()
+               << std::setw(12) << s.inputWaitSeconds << std::setw(12) << s.outputWaitSeconds << "\n";
+        if (pipelined) {
+            os << "  queue max depth:";
+            for (size_t d : queueMaxDepth) os << " " << d << "/" << queueCapacity;
+            os << "\n";
+        }
+    }
+};
+
+// Trains a LinearModel on many CSV-like shard files with one thread per stage:
+//
+//   parse --queue--> transform --queue--> accumulate (A^T A, A^T b) --> solve
+//
+// The queues are bounded, so parsing shard k+1 overlaps the math on shard k without
+// reading everything into memory first, and the end-to-end time approaches the slowest
+// stage instead of the sum of all stages. Batches stay in file order and a single thread
+// accumulates, so the result is bitwise identical to trainSerial().
+// An unfitted affine pipeline with one fitted stage (z-score + intercept) is fitted in the
+// same pass: the stage observes the raw rows while their Gram matrix is accumulated, and the
+// fitted map z = T [x; 1] is applied to that matrix afterwards. Other unfitted pipelines get
+// one extra pass over the shards per stage that needs statistics, run through the same
+// threads. Either way the model matches LinearModel::fit on all rows in memory.
+class ShardTrainer {
+public:
+    // Parse one line into features[0..inDim) and target; false skips the line, throw on bad data
+    using LineParser = std::function<bool(const std::string& line, double* features, double& target)>;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Batch {
+        int shard = 0;
+        int rows = 0;
+        std::vector<double> values;     // rows x width, row-major (raw or expanded)
+        std::vector<double> targets;
+    };
+
+    using Emit = std::function<bool(Batch&&)>;
+    using Transform = std::function<bool(Batch&&, StageStats&, const Emit&)>;
+    using Consume = std::function<void(const Batch&, StageStats&)>;
+    using Observe = std::function<void(const double*, int)>;
+
+    int mInDim;
+    LineParser mParser;
+    double mLambda;
+    int mBatchRows;
+    int mQueueDepth;
+    TrainingReport mReport;
+
+    static double since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Stopwatch for a stage's busy time that excludes the time spent handing batches on
+    class Busy {
+        StageStats& mStats;
+        Clock::time_point mStart;
+    public:
+        explicit Busy(StageStats& stats) : mStats(stats), mStart(Clock::now()) {}
+        void pause() { mStats.busySeconds += since(mStart); }
+        void resume() { mStart = Clock::now(); }
+        ~Busy() { pause(); }
+    };
+
+    // Stage 1: read the shards line by line, emit batches of mBatchRows raw rows
+    void parse(const std::vector<std::string>& shards, StageStats& stats, const Emit& emit) {
+        Busy busy(stats);
+        std::string line;
+        for (size_t k = 0; k < shards.size(); ++k) {
+            std::ifstream file(shards[k]);
+            if (!file.is_open()) throw std::runtime_error("\n>> Error: Cannot open shard: " + shards[k]);
+            Batch batch;
+            auto flush = [&]() {
+                if (batch.rows == 0) return true;
+                stats.rows += batch.rows;
+                ++stats.batches;
+                busy.pause();
+                bool ok = emit(std::move(batch));
+                busy.resume();
+                batch = Batch();
+                return ok;
+            };
+            double target;
+            while (std::getline(file, line)) {
+                if (batch.rows == 0) {
+                    batch.shard = static_cast<int>(k);
+                    batch.values.resize(static_cast<size_t>(mBatchRows) * mInDim);
+                    batch.targets.resize(mBatchRows);
+                }
+                if (!mParser(line, batch.values.data() + static_cast<size_t>(batch.rows) * mInDim, target)) continue;
+                batch.targets[batch.rows++] = target;
+                if (batch.rows == mBatchRows && !flush()) return;
+            }
+            batch.values.resize(static_cast<size_t>(batch.rows) * mInDim);
+            batch.targets.resize(batch.rows);
+            if (!flush()) return;
+        }
+    }
+
+    // Stage 2: expand raw batches through the (fitted) pipeline
+    static bool expand(const FeaturePipeline& pipeline, Batch&& raw, StageStats& stats, const Emit& emit) {
+        Busy busy(stats);
+        int p = pipeline.outDim();
+        Batch out;
+        out.shard = raw.shard;
+        out.rows = raw.rows;
+        out.values.resize(static_cast<size_t>(raw.rows) * p);
+        pipeline.transformRows(raw.values.data(), raw.rows, out.values.data());
+        out.targets = std::move(raw.targets);
+        stats.rows += out.rows;
+        ++stats.batches;
+        busy.pause();
+        bool ok = emit(std::move(out));
+        busy.resume();
+        return ok;
+    }
+
+    // Stage 2 of a one-pass fit: the pipeline observes the raw rows, which are then emitted as
+    // u = [x - x0; 1]. Shifting by the first row x0 keeps the raw Gram matrix well scaled.
+    bool observeShifted(const Observe& observe, std::vector<double>& x0, Batch&& raw, StageStats& stats, const Emit& emit) {
+        Busy busy(stats);
+        observe(raw.values.data(), raw.rows);
+        if (x0.empty()) x0.assign(raw.values.begin(), raw.values.begin() + mInDim);
+        int width = mInDim + 1;
+        Batch out;
+        out.shard = raw.shard;
+        out.rows = raw.rows;
+        out.values.resize(static_cast<size_t>(raw.rows) * width);
+        for (int r = 0; r < raw.rows; ++r) {
+            const double* x = raw.values.data() + static_cast<size_t>(r) * mInDim;
+            double* u = out.values.data() + static_cast<size_t>(r) * width;
+            for (int j = 0; j < mInDim; ++j) u[j] = x[j] - x0[j];
+            u[mInDim] = 1.0;
+        }
+        out.targets = std::move(raw.targets);
+        stats.rows += out.rows;
+        ++stats.batches;
+        busy.pause();
+        bool ok = emit(std::move(out));
+        busy.resume();
+        return ok;
+    }
+
+    // Stage 3: A^T A += Z^T Z, A^T b += Z^T y
+    static void accumulate(const Batch& z, SymmetricMatrix& ATA, Vector& ATb, StageStats& stats) {
+        Busy busy(stats);
+        FeaturePipeline::accumulateExpanded(z.values.data(), z.rows, z.targets.data(), ATA, ATb);
+        stats.rows += z.rows;
+        ++stats.batches;
+    }
+
+    // parse -> transform -> consume over all shards: one thread per stage with bounded queues
+    // in between, or one after another on the calling thread. stages[0..2] get the counters.
+    void run(const std::vector<std::string>& shards, bool pipelined, std::vector<StageStats>& stages,
+             const Transform& transform, const Consume& consume, std::vector<size_t>& queueMaxDepth) {
+        StageStats& parseStats = stages[0];
+        StageStats& transformStats = stages[1];
+        StageStats& consumeStats = stages[2];
+        if (!pipelined) {
+            Emit consumeBatch = [&](Batch&& z) {
+                consume(z, consumeStats);
+                return true;
+            };
+            parse(shards, parseStats, [&](Batch&& b) { return transform(std::move(b), transformStats, consumeBatch); });
+            return;
+        }
+
+        BoundedQueue<Batch> rawQueue(mQueueDepth), expandedQueue(mQueueDepth);
+        std::exception_ptr errors[3];
+        auto abort = [&]() { rawQueue.close(); expandedQueue.close(); };
+
+        std::thread parser([&] {
+            try {
+                parse(shards, parseStats, [&](Batch&& b) { return rawQueue.push(std::move(b)); });
+            } catch (...) { errors[0] = std::current_exception(); abort(); }
+            rawQueue.close();
+        });
+        std::thread transformer([&] {
+            try {
+                Emit emit = [&](Batch&& b) { return expandedQueue.push(std::move(b)); };
+                Batch b;
+                while (rawQueue.pop(b))
+                    if (!transform(std::move(b), transformStats, emit)) break;
+            } catch (...) { errors[1] = std::current_exception(); abort(); }
+            expandedQueue.close();
+        });
+        std::thread consumer([&] {
+            try {
+                Batch z;
+                while (expandedQueue.pop(z)) consume(z, consumeStats);
+            } catch (...) { errors[2] = std::current_exception(); abort(); }
+        });
+        parser.join();
+        transformer.join();
+        consumer.join();
+        for (auto& e : errors)
+            if (e) std::rethrow_exception(e);
+
+        BoundedQueue<Batch>::Stats q1 = rawQueue.stats(), q2 = expandedQueue.stats();
+        parseStats.outputWaitSeconds += q1.pushWaitSeconds;
+        transformStats.inputWaitSeconds += q1.popWaitSeconds;
+        transformStats.outputWaitSeconds += q2.pushWaitSeconds;
+        consumeStats.inputWaitSeconds += q2.popWaitSeconds;
+        queueMaxDepth = {q1.maxDepth, q2.maxDepth};
+    }
+
+    // Extra streaming passes for pipelines that cannot be fitted in the training pass: each
+    // pass parses every shard again, on the same threads as training
+    void fitPipeline(FeaturePipeline& pipeline, const std::vector<std::string>& shards, bool pipelined) {
+        Clock::time_point start = Clock::now();
+        pipeline.fitStreaming(mInDim, [&](const Observe& observe) {
+            std::vector<StageStats> ignored(3);
+            std::vector<size_t> depths;
+            run(shards, pipelined, ignored,
+                [&](Batch&& b, StageStats&, const Emit&) {
+                    observe(b.values.data(), b.rows);
+                    return true;
+                },
+                [](const Batch&, StageStats&) {}, depths);
+            ++mReport.fitPasses;
+        });
+        mReport.fitSeconds = since(start);
+    }
+
+    // A^T A = T' G T'^T and A^T b = T' g from the shifted raw sums G, g of a one-pass fit, where
+    // z = T [x; 1] = T' [x - x0; 1] with T' = [T_x, T_x x0 + t]
+    static void projectNormal(const FeaturePipeline& pipeline, const SymmetricMatrix& G, const Vector& g,
+                              const std::vector<double>& x0, SymmetricMatrix& ATA, Vector& ATb) {
+        int d = pipeline.inDim(), cols = d + 1, p = pipeline.outDim();
+        std::vector<double> T = pipeline.affineMap();
+        for (int i = 0; i < p; ++i) {
+            double* row = T.data() + static_cast<size_t>(i) * cols;
+            for (int k = 0; k < d; ++k) row[d] += row[k] * x0[k];
+        }
+        std::vector<double> W(static_cast<size_t>(p) * cols, 0.0);   // T' G
+        for (int i = 0; i < p; ++i)
+            for (int a = 0; a < cols; ++a) {
+                double s = 0.0;
+                for (int b = 0; b < cols; ++b) s += T[static_cast<size_t>(i) * cols + b] * G(b + 1, a + 1);
+                W[static_cast<size_t>(i) * cols + a] = s;
+            }
+        ATA = SymmetricMatrix(p);
+        ATb = Vector(p, 0.0);
+        for (int i = 0; i < p; ++i) {
+            for (int j = 0; j <= i; ++j) {
+                double s = 0.0;
+                for (int a = 0; a < cols; ++a) s += W[static_cast<size_t>(i) * cols + a] * T[static_cast<size_t>(j) * cols + a];
+                ATA(i + 1, j + 1) = s;
+            }
+            double s = 0.0;
+            for (int a = 0; a < cols; ++a) s += T[static_cast<size_t>(i) * cols + a] * g(a + 1);
+            ATb(i + 1) = s;
+        }
+    }
+
+    void beginReport(const std::vector<std::string>& shards, bool pipelined) {
+        mReport = TrainingReport();
+        mReport.pipelined = pipelined;
+        mReport.shards = static_cast<int>(shards.size());
+        mReport.queueCapacity = mQueueDepth;
+        for (const char* name : {"parse", "transform", "accumulate", "solve"}) {
+            StageStats s;
+            s.name = name;
+            mReport.stages.push_back(s);
+        }
+        if (shards.empty()) throw std::invalid_argument("No shards to train on.");
+    }
+
+    LinearModel trainWith(FeaturePipeline& pipeline, const std::vector<std::string>& shards, bool pipelined) {
+        Clock::time_point start = Clock::now();
+        beginReport(shards, pipelined);
+        if (pipeline.inDim() >= 0 && pipeline.inDim() != mInDim)
+            throw std::invalid_argument("Pipeline was fitted on " + std::to_string(pipeline.inDim())
+                                        + " features, the trainer parses " + std::to_string(mInDim) + ".");
+        std::vector<StageStats>& stages = mReport.stages;
+        SymmetricMatrix ATA;
+        Vector ATb;
+
+        if (pipeline.inDim() < 0 && pipeline.affine() && pipeline.fitPasses() == 1) {
+            SymmetricMatrix G(mInDim + 1);
+            Vector g(mInDim + 1, 0.0);
+            std::vector<double> x0;
+            pipeline.fitStreaming(mInDim, [&](const Observe& observe) {
+                run(shards, pipelined, stages,
+                    [&](Batch&& b, StageStats& stats, const Emit& emit) { return observeShifted(observe, x0, std::move(b), stats, emit); },
+                    [&](const Batch& u, StageStats& stats) { accumulate(u, G, g, stats); },
+                    mReport.queueMaxDepth);
+            });
+            mReport.fitInTrainingPass = true;
+            Busy busy(stages[3]);
+            projectNormal(pipeline, G, g, x0, ATA, ATb);
+        } else {
+            if (pipeline.inDim() < 0) fitPipeline(pipeline, shards, pipelined);
+            int p = pipeline.outDim();
+            ATA = SymmetricMatrix(p);
+            ATb = Vector(p, 0.0);
+            run(shards, pipelined, stages,
+                [&](Batch&& b, StageStats& stats, const Emit& emit) { return expand(pipeline, std::move(b), stats, emit); },
+                [&](const Batch& z, StageStats& stats) { accumulate(z, ATA, ATb, stats); },
+                mReport.queueMaxDepth);
+        }
+
+        LinearModel model = solve(pipeline, ATA, ATb);
+        mReport.totalSeconds = since(start);
+        return model;
+    }
+
+    LinearModel solve(FeaturePipeline& pipeline, const SymmetricMatrix& ATA, const Vector& ATb) {
+        StageStats& stats = mReport.stages[3];
+        if (mReport.stages[2].rows == 0) throw std::runtime_error("\n>> Error: The shards contain no rows.");
+        Vector coef;
+        {
+            Busy busy(stats);
+            coef = LeastSquaresSystem::solveNormal(ATA, ATb, mLambda);
+            stats.batches = 1;
+            stats.rows = mReport.stages[2].rows;
+        }
+        mReport.rows = stats.rows;
+        LinearModel model(std::move(pipeline));
+        model.setCoefficients(coef);
+        return model;
+    }
+
+public:
+    ShardTrainer(int inDim, LineParser parser, double lambda, int batchRows = 4096, int queueDepth = 4)
+    : mInDim(inDim), mParser(std::move(parser)), mLambda(lambda),
+      mBatchRows(std::max(1, batchRows)), mQueueDepth(std::max(1, queueDepth)) {
+        if (inDim < 1) throw std::invalid_argument("Need at least one feature.");
+    }
+
+    // One thread per stage, bounded queues in between
+    LinearModel train(FeaturePipeline pipeline, const std::vector<std::string>& shards) {
+        return trainWith(pipeline, shards, true);
+    }
+
+    // Same stages one after another on the calling thread (baseline for the report)
+    LinearModel trainSerial(FeaturePipeline pipeline, const std::vector<std::string>& shards) {
+        return trainWith(pipeline, shards, false);
+    }
+
+    const TrainingReport& report() const { return mReport; }
+};
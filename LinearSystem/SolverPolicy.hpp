@@ -0,0 +1,340 @@
+// SolverPolicy.hpp
+#pragma once
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <Eigen/Dense>
+#include <Eigen/IterativeLinearSolvers>
+#include "Matrix.hpp"
+#include "Vector.hpp"
+#include "SymmetricMatrix.hpp"
+
+enum class SolverMethod { Auto, Cholesky, LU, QR, CG, SVD };
+
+// What the policy saw and what it chose for the last solve on this thread
+struct SolverDecision {
+    SolverMethod method = SolverMethod::Auto;
+    int rows = 0;
+    int cols = 0;
+    bool symmetric = false;
+    double density = 1.0;       // fraction of nonzero entries
+    double rcond = std::nan(""); // reciprocal 1-norm condition estimate (NaN if not estimated)
+    double seconds = 0.0;       // analysis + factorization + solve
+    std::string reason;
+};
+
+// Picks the cheapest solver that is still accurate for a system:
+//   square, symmetric, large and sparse   -> CG (falls back to Cholesky if it does not converge)
+//   square, symmetric positive definite   -> Cholesky
+//   square, well conditioned              -> LU (partial pivoting)
+//   square, ill conditioned               -> QR (column pivoting)
+//   near singular / underdetermined       -> SVD (minimum-norm solution)
+//   overdetermined                        -> Cholesky on A^T A, QR or SVD by conditioning
+// The condition number is estimated from the factorization that is used anyway
+// (Hager/Higham 1-norm estimator, Eigen's rcond()), so the estimate costs O(n^2).
+// Packed SymmetricMatrix systems are factored in place by SymmetricMatrix::cholesky() and
+// only expanded to a dense matrix when CG or a non-Cholesky fallback is needed.
+class SolverPolicy {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static std::ostream*& logStream() {
+        static std::ostream* out = nullptr;
+        return out;
+    }
+
+    static SolverDecision& lastDecision() {
+        thread_local SolverDecision decision;
+        return decision;
+    }
+
+    static double density(const Matrix& A) {
+        long long nonzero = 0;
+        for (int i = 1; i <= A.rows(); ++i) {
+            const double* row = A.row(i);
+            for (int j = 0; j < A.cols(); ++j) nonzero += row[j] != 0.0;
+        }
+        return static_cast<double>(nonzero) / (static_cast<double>(A.rows()) * A.cols());
+    }
+
+    // Nonzeros of the full matrix, counted from the packed triangle
+    static double density(const SymmetricMatrix& S) {
+        int n = S.size();
+        if (n == 0) return 1.0;
+        long long nonzero = 0;
+        const double* a = S.data();
+        for (int i = 0, k = 0; i < n; ++i)
+            for (int j = 0; j <= i; ++j, ++k)
+                if (a[k] != 0.0) nonzero += i == j ? 1 : 2;
+        return static_cast<double>(nonzero) / (static_cast<double>(n) * n);
+    }
+
+    // Reciprocal 1-norm condition estimate of S = L L^T with Hager's estimator (as in
+    // LAPACK's dpocon): a few solves with L instead of forming S^{-1}
+    static double rcond(const SymmetricMatrix& S, const TriangularMatrix& L) {
+        int n = S.size();
+        if (n == 0) return 1.0;
+        std::vector<double> colSum(n, 0.0);
+        const double* a = S.data();
+        for (int i = 0, k = 0; i < n; ++i)
+            for (int j = 0; j <= i; ++j, ++k) {
+                colSum[j] += std::fabs(a[k]);
+                if (j != i) colSum[i] += std::fabs(a[k]);
+            }
+        double norm = *std::max_element(colSum.begin(), colSum.end());
+
+        // Maximize ||S^{-1} x||_1 over ||x||_1 = 1, starting from the uniform vector
+        Vector x(n, 1.0 / n);
+        double inverseNorm = 0.0;
+        for (int it = 0; it < 5; ++it) {
+            Vector y = L.transposeSolve(L.solve(x));
+            Vector sign(n, 1.0);
+            inverseNorm = 0.0;
+            for (int i = 1; i <= n; ++i) {
+                inverseNorm += std::fabs(y(i));
+                if (y(i) < 0.0) sign(i) = -1.0;
+            }
+            Vector z = L.transposeSolve(L.solve(sign));   // S^{-T} = S^{-1}
+            int best = 1;
+            double zx = 0.0;
+            for (int i = 1; i <= n; ++i) {
+                zx += z(i) * x(i);
+                if (std::fabs(z(i)) > std::fabs(z(best))) best = i;
+            }
+            if (std::fabs(z(best)) <= zx) break;
+            x = Vector(n, 0.0);
+            x(best) = 1.0;
+        }
+        return norm > 0.0 && inverseNorm > 0.0 ? 1.0 / (norm * inverseNorm) : 0.0;
+    }
+
+    // NaN-safe: a NaN estimate (exactly singular factor) never passes
+    static bool above(double rcond, double threshold) { return rcond >= threshold; }
+
+    static Vector finish(SolverDecision& d, SolverMethod method, const std::string& reason,
+                         Clock::time_point start, Vector x) {
+        d.method = method;
+        d.reason = reason;
+        d.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        lastDecision() = d;
+        if (logStream()) *logStream() << "[SolverPolicy] " << describe(d) << std::endl;
+        return x;
+    }
+
+    static Vector finish(SolverDecision& d, SolverMethod method, const std::string& reason,
+                         Clock::time_point start, const Eigen::VectorXd& x) {
+        return finish(d, method, reason, start, Vector(x));
+    }
+
+    static Vector svd(SolverDecision& d, const Eigen::MatrixXd& A, const Eigen::VectorXd& b,
+                      const std::string& reason, Clock::time_point start) {
+        Eigen::BDCSVD<Eigen::MatrixXd> svd(A, Eigen::ComputeThinU | Eigen::ComputeThinV);
+        Eigen::VectorXd s = svd.singularValues();
+        if (s.size() > 0 && s(0) > 0.0) d.rcond = s(s.size() - 1) / s(0);
+        return finish(d, SolverMethod::SVD, reason, start, svd.solve(b));
+    }
+
+    // CG on the nonzeros only; false if it did not converge
+    static bool conjugateGradient(const Eigen::MatrixXd& M, const Eigen::VectorXd& b, Eigen::VectorXd& x) {
+        Eigen::SparseMatrix<double> S = M.sparseView();
+        Eigen::ConjugateGradient<Eigen::SparseMatrix<double>, Eigen::Lower | Eigen::Upper> cg;
+        cg.setTolerance(tolerance());
+        cg.compute(S);
+        x = cg.solve(b);
+        return cg.info() == Eigen::Success;
+    }
+
+    static Vector solveDenseSymmetric(SolverDecision& d, const Eigen::MatrixXd& M, const Eigen::VectorXd& b,
+                                 SolverMethod forced, Clock::time_point start) {
+        bool sparse = d.rows >= cgMinSize() && d.density <= cgMaxDensity();
+        if (forced == SolverMethod::CG || (forced == SolverMethod::Auto && sparse)) {
+            Eigen::VectorXd x;
+            if (conjugateGradient(M, b, x) || forced == SolverMethod::CG)
+                return finish(d, SolverMethod::CG, forced == SolverMethod::CG ? "forced" : "large sparse symmetric", start, x);
+        }
+        if (forced == SolverMethod::Auto || forced == SolverMethod::Cholesky) {
+            Eigen::LLT<Eigen::MatrixXd> llt(M);
+            if (llt.info() == Eigen::Success) {
+                d.rcond = llt.rcond();
+                if (forced == SolverMethod::Cholesky || above(d.rcond, luThreshold()))
+                    return finish(d, SolverMethod::Cholesky, forced == SolverMethod::Cholesky ? "forced" : "symmetric positive definite", start, llt.solve(b));
+            } else if (forced == SolverMethod::Cholesky) {
+                throw std::runtime_error("\nError: Cholesky requested but the matrix is not positive definite.");
+            }
+        }
+        return solveGeneral(d, M, b, forced, start);
+    }
+
+    // Square A x = b; `symmetric` is what the caller knows or has checked about A
+    static Vector solveSquare(const Matrix& A, const Vector& b, SolverMethod forced, bool symmetric) {
+        if (A.rows() != b.size()) throw std::invalid_argument("Incompatible matrix/vector sizes");
+        Clock::time_point start = Clock::now();
+        SolverDecision d;
+        d.rows = A.rows();
+        d.cols = A.cols();
+        d.symmetric = symmetric;
+        d.density = density(A);
+        Eigen::MatrixXd M = A.toEigen();
+        Eigen::VectorXd rhs = b.toEigen();
+        if (d.symmetric && forced != SolverMethod::LU && forced != SolverMethod::QR && forced != SolverMethod::SVD)
+            return solveDenseSymmetric(d, M, rhs, forced, start);
+        if (forced == SolverMethod::Cholesky || forced == SolverMethod::CG)
+            throw std::invalid_argument(std::string(name(forced)) + " needs a symmetric matrix");
+        return solveGeneral(d, M, rhs, forced, start);
+    }
+
+    static Vector solveGeneral(SolverDecision& d, const Eigen::MatrixXd& M, const Eigen::VectorXd& b,
+                               SolverMethod forced, Clock::time_point start) {
+        if (forced == SolverMethod::SVD) return svd(d, M, b, "forced", start);
+        if (forced == SolverMethod::QR)
+            return finish(d, SolverMethod::QR, "forced", start, M.colPivHouseholderQr().solve(b));
+
+        Eigen::PartialPivLU<Eigen::MatrixXd> lu(M);
+        d.rcond = lu.rcond();
+        if (forced == SolverMethod::LU || above(d.rcond, luThreshold()))
+            return finish(d, SolverMethod::LU, forced == SolverMethod::LU ? "forced" : "well conditioned", start, lu.solve(b));
+        if (above(d.rcond, svdThreshold()))
+            return finish(d, SolverMethod::QR, "ill conditioned", start, M.colPivHouseholderQr().solve(b));
+        return svd(d, M, b, "near singular", start);
+    }
+
+public:
+    // Where decisions are logged (nullptr = silent, the default)
+    static void setLog(std::ostream* out) { logStream() = out; }
+
+    // rcond below which LU / Cholesky are not trusted and QR is used
+    static double& luThreshold() {
+        static double t = 1e-8;
+        return t;
+    }
+    // rcond below which the system is treated as singular and solved by SVD
+    static double& svdThreshold() {
+        static double t = 1e-13;
+        return t;
+    }
+    // CG is only tried for symmetric systems at least this large and at most this dense
+    static int& cgMinSize() {
+        static int n = 200;
+        return n;
+    }
+    static double& cgMaxDensity() {
+        static double d = 0.05;
+        return d;
+    }
+    // Relative residual at which CG stops
+    static double& tolerance() {
+        static double t = 1e-12;
+        return t;
+    }
+
+    static const SolverDecision& last() { return lastDecision(); }
+
+    static const char* name(SolverMethod method) {
+        switch (method) {
+            case SolverMethod::Cholesky: return "Cholesky";
+            case SolverMethod::LU: return "LU";
+            case SolverMethod::QR: return "QR";
+            case SolverMethod::CG: return "CG";
+            case SolverMethod::SVD: return "SVD";
+            default: return "Auto";
+        }
+    }
+
+    static std::string describe(const SolverDecision& d) {
+        std::ostringstream out;
+        out << d.rows << "x" << d.cols << (d.symmetric ? " symmetric" : "")
+            << ", density " << d.density << ", rcond " << d.rcond
+            << " -> " << name(d.method) << " (" << d.reason << ", " << d.seconds * 1e6 << " us)";
+        return out.str();
+    }
+
+    // A x = b; non-square systems are solved in the least-squares sense
+    static Vector solve(const Matrix& A, const Vector& b, SolverMethod forced = SolverMethod::Auto) {
+        if (A.rows() != A.cols()) return leastSquares(A, b, forced);
+        return solveSquare(A, b, forced, A.isSymmetric());
+    }
+
+    // A x = b for a square A the caller already knows to be symmetric (skips the O(n^2) check)
+    static Vector solveSymmetric(const Matrix& A, const Vector& b, SolverMethod forced = SolverMethod::Auto) {
+        if (A.rows() != A.cols()) throw std::invalid_argument("Matrix is not square");
+        return solveSquare(A, b, forced, true);
+    }
+
+    // Packed symmetric system S x = b. Cholesky runs on the packed storage; the dense
+    // matrix is only built for CG (large and sparse) or when Cholesky is not usable.
+    static Vector solve(const SymmetricMatrix& S, const Vector& b, SolverMethod forced = SolverMethod::Auto) {
+        if (S.size() != b.size()) throw std::invalid_argument("Incompatible matrix/vector sizes");
+        Clock::time_point start = Clock::now();
+        SolverDecision d;
+        d.rows = d.cols = S.size();
+        d.symmetric = true;
+        d.density = density(S);
+        bool sparse = d.rows >= cgMinSize() && d.density <= cgMaxDensity();
+        if (forced == SolverMethod::Cholesky || (forced == SolverMethod::Auto && !sparse)) {
+            bool factored = false;
+            TriangularMatrix L;
+            try {
+                L = S.cholesky();
+                factored = true;
+            } catch (const std::runtime_error&) {
+                if (forced == SolverMethod::Cholesky)
+                    throw std::runtime_error("\nError: Cholesky requested but the matrix is not positive definite.");
+            }
+            if (factored) {
+                d.rcond = rcond(S, L);
+                if (forced == SolverMethod::Cholesky || above(d.rcond, luThreshold()))
+                    return finish(d, SolverMethod::Cholesky, forced == SolverMethod::Cholesky ? "forced" : "symmetric positive definite",
+                                  start, L.transposeSolve(L.solve(b)));
+            }
+            return solveGeneral(d, S.toEigen(), b.toEigen(), SolverMethod::Auto, start);
+        }
+        return solveDenseSymmetric(d, S.toEigen(), b.toEigen(), forced, start);
+    }
+
+    // Least-squares / minimum-norm solution of A x = b for any shape
+    static Vector leastSquares(const Matrix& A, const Vector& b, SolverMethod forced = SolverMethod::Auto) {
+        if (A.rows() != b.size()) throw std::invalid_argument("Incompatible matrix/vector sizes");
+        if (A.rows() == A.cols()) return solve(A, b, forced);
+        Clock::time_point start = Clock::now();
+        SolverDecision d;
+        d.rows = A.rows();
+        d.cols = A.cols();
+        d.density = density(A);
+        Eigen::MatrixXd M = A.toEigen();
+        Eigen::VectorXd rhs = b.toEigen();
+
+        if (forced == SolverMethod::SVD || (forced == SolverMethod::Auto && A.rows() < A.cols()))
+            return svd(d, M, rhs, forced == SolverMethod::SVD ? "forced" : "underdetermined", start);
+
+        // Normal equations are the cheapest (m n^2 / 2 flops) but square the condition
+        // number, so they are only used when A^T A is itself well conditioned
+        if (forced == SolverMethod::Auto || forced == SolverMethod::Cholesky) {
+            SymmetricMatrix ATA(A.cols());
+            ATA.rankUpdate(A);
+            Eigen::LLT<Eigen::MatrixXd> llt(ATA.toEigen());
+            if (llt.info() == Eigen::Success) {
+                d.rcond = llt.rcond();
+                if (forced == SolverMethod::Cholesky || above(d.rcond, luThreshold()))
+                    return finish(d, SolverMethod::Cholesky, forced == SolverMethod::Cholesky ? "forced" : "overdetermined, well conditioned",
+                                  start, llt.solve(M.transpose() * rhs));
+            } else if (forced == SolverMethod::Cholesky) {
+                throw std::runtime_error("\nError: Cholesky requested but A^T A is not positive definite.");
+            }
+        }
+        if (forced != SolverMethod::Auto && forced != SolverMethod::QR)
+            throw std::invalid_argument(std::string(name(forced)) + " cannot solve a non-square system");
+
+        // Pivoted QR: |r_nn| / |r_11| estimates 1 / cond(A)
+        Eigen::ColPivHouseholderQR<Eigen::MatrixXd> qr(M);
+        Eigen::VectorXd diag = qr.matrixQR().diagonal().cwiseAbs();
+        d.rcond = diag.size() && diag(0) > 0.0 ? diag(diag.size() - 1) / diag(0) : 0.0;
+        if (forced == SolverMethod::QR || above(d.rcond, svdThreshold()))
+            return finish(d, SolverMethod::QR, forced == SolverMethod::QR ? "forced" : "overdetermined, ill conditioned", start, qr.solve(rhs));
+        return svd(d, M, rhs, "rank deficient", start);
+    }
+};
@@ -0,0 +1,202 @@
+// SymmetricMatrix.hpp
+#pragma once
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "PackedMatrix.hpp"
+#include "TriangularMatrix.hpp"
+#include "Matrix.hpp"
+#include "Vector.hpp"
+#include "VectorKernels.hpp"
+#include "Parallel.hpp"
+
+// Symmetric n x n matrix storing only its lower triangle, so symmetry holds by construction.
+// Used for Gram matrices A^T A and as input to PosSymLinSystem.
+class SymmetricMatrix : public PackedMatrix {
+public:
+    SymmetricMatrix(int n = 0) : PackedMatrix(n) {}
+
+    // Lower triangle of a full matrix (the upper one is not checked)
+    static SymmetricMatrix fromLower(const Matrix& A) {
+        if (A.rows() != A.cols()) throw std::invalid_argument("Matrix is not square");
+        SymmetricMatrix S(A.rows());
+        for (int i = 0; i < S.mSize; ++i) {
+            const double* row = A.row(i + 1);
+            std::copy(row, row + i + 1, S.mData + index(i, 0));
+        }
+        return S;
+    }
+
+    // Access element (1-based); (i, j) and (j, i) are the same entry
+    double& operator()(int i, int j) {
+        checkIndex(i, j);
+        return i >= j ? mData[index(i - 1, j - 1)] : mData[index(j - 1, i - 1)];
+    }
+
+    double operator()(int i, int j) const {
+        checkIndex(i, j);
+        return i >= j ? mData[index(i - 1, j - 1)] : mData[index(j - 1, i - 1)];
+    }
+
+    Matrix toMatrix() const {
+        Matrix M(mSize, mSize);
+        for (int i = 0; i < mSize; ++i) {
+            double* row = M.row(i + 1);
+            for (int j = 0; j <= i; ++j) row[j] = M.row(j + 1)[i] = mData[index(i, j)];
+        }
+        return M;
+    }
+
+    Eigen::MatrixXd toEigen() const {
+        Eigen::MatrixXd mat(mSize, mSize);
+        for (int i = 0; i < mSize; ++i)
+            for (int j = 0; j <= i; ++j) mat(i, j) = mat(j, i) = mData[index(i, j)];
+        return mat;
+    }
+
+    void addDiagonal(double lambda) {
+        for (int i = 0; i < mSize; ++i) mData[index(i, i)] += lambda;
+    }
+
+    // Symmetric matrix-vector product, reading each stored entry once
+    Vector operator*(const Vector& x) const {
+        if (x.size() != mSize) throw std::runtime_error("Incompatible sizes.");
+        Vector y(mSize, 0.0);
+        const double* px = x.data();
+        double* py = y.data();
+        for (int i = 0; i < mSize; ++i) {
+            const double* row = mData + index(i, 0);
+            double xi = px[i];
+            double s = 0.0;
+            for (int j = 0; j < i; ++j) {
+                s += row[j] * px[j];
+                py[j] += row[j] * xi;
+            }
+            py[i] += s + row[i] * xi;
+        }
+        return y;
+    }
+
+    // Rank-k update: this += alpha * A^T A (A is m x n). Rows are split into slices whose
+    // partial Gram matrices are summed by Parallel's rules, so the result is reproducible
+    // across thread counts when Parallel::reproducible() is on.
+    void rankUpdate(const Matrix& A, double alpha = 1.0) {
+        if (A.cols() != mSize) throw std::runtime_error("Incompatible sizes.");
+        const int kBlockRows = 256;
+        int rows = A.rows();
+        size_t packed = packedSize(mSize);
+        int maxSlices = static_cast<int>(std::max<size_t>(1, (size_t(8) << 20) / std::max<size_t>(1, packed)));   // partials <= 64 MB
+        int slices = Parallel::sliceCount(rows, kBlockRows, maxSlices);
+        if (slices <= 1 && !Parallel::reproducible()) {
+            for (int r = 0; r < rows; r += kBlockRows)
+                accumulateRows(mData, mSize, A.row(r + 1), std::min(kBlockRows, rows - r), alpha);
+            return;
+        }
+        std::vector<double> partial(static_cast<size_t>(slices) * packed, 0.0);
+        Parallel::reduceSlices(rows, kBlockRows, maxSlices, [&](int s, int begin, int end) {
+            double* g = partial.data() + static_cast<size_t>(s) * packed;
+            for (int r = begin; r < end; r += kBlockRows)
+                accumulateRows(g, mSize, A.row(r + 1), std::min(kBlockRows, end - r), alpha);
+        });
+        Parallel::pairwise(slices, [&](int i, int j) {
+            double* gi = partial.data() + static_cast<size_t>(i) * packed;
+            const double* gj = partial.data() + static_cast<size_t>(j) * packed;
+            for (size_t k = 0; k < packed; ++k) gi[k] += gj[k];
+        });
+        for (size_t k = 0; k < packed; ++k) mData[k] += partial[k];
+    }
+
+    // this += alpha * a a^T for one row a of length n
+    void rankOneUpdate(const double* a, double alpha = 1.0) { accumulate(mData, mSize, a, alpha); }
+
+    // g += alpha * a a^T on a packed lower triangle of size n
+    static void accumulate(double* g, int n, const double* a, double alpha) {
+        for (int i = 0; i < n; ++i) {
+            double ai = alpha * a[i];
+            double* row = g + index(i, 0);
+            for (int j = 0; j <= i; ++j) row[j] += ai * a[j];
+        }
+    }
+
+    // g += alpha * sum of a a^T over `rows` rows stored back to back (row-major, length n).
+    // The triangle is walked in square tiles that stay in cache while the rows stream past,
+    // instead of sweeping all n^2/2 entries once per row. Each entry still adds the rows in
+    // order (axpy does not fuse the multiply-add), so the result is bitwise the same as one
+    // accumulate() per row.
+    static void accumulateRows(double* g, int n, const double* A, int rows, double alpha) {
+        const int kTile = 96;   // 96 x 96 doubles = 72 KB
+        if (n <= kTile) {
+            for (int r = 0; r < rows; ++r) accumulate(g, n, A + static_cast<size_t>(r) * n, alpha);
+            return;
+        }
+        for (int i0 = 0; i0 < n; i0 += kTile) {
+            int i1 = std::min(n, i0 + kTile);
+            for (int j0 = 0; j0 <= i0; j0 += kTile) {
+                for (int r = 0; r < rows; ++r) {
+                    const double* a = A + static_cast<size_t>(r) * n;
+                    for (int i = i0; i < i1; ++i) {
+                        double ai = alpha * a[i];
+                        double* row = g + index(i, 0);
+                        int j1 = std::min(i + 1, j0 + kTile);
+                        VectorKernels::axpy(ai, a + j0, row + j0, row + j0, j1 - j0);
+                    }
+                }
+            }
+        }
+    }
+
+    // Cholesky factor L (lower) with this = L L^T
+    TriangularMatrix cholesky() const {
+        TriangularMatrix L(mSize);
+        double* l = L.data();
+        for (int i = 0; i < mSize; ++i) {
+            double* li = l + index(i, 0);
+            const double* ai = mData + index(i, 0);
+            for (int j = 0; j <= i; ++j) {
+                const double* lj = l + index(j, 0);
+                double s = ai[j];
+                for (int k = 0; k < j; ++k) s -= li[k] * lj[k];
+                if (j < i) {
+                    li[j] = s / lj[j];
+                } else {
+                    if (s <= 0.0) throw std::runtime_error("\nError: Matrix is not positive definite.");
+                    li[i] = std::sqrt(s);
+                }
+            }
+        }
+        return L;
+    }
+
+    // Ax = b through the Cholesky factor
+    Vector solve(const Vector& b) const {
+        TriangularMatrix L = cholesky();
+        return L.transposeSolve(L.solve(b));
+    }
+
+    // Conjugate Gradient on the packed matrix (matrix must be positive definite)
+    Vector conjugateGradient(const Vector& b, double tolerance = 1e-14) const {
+        if (b.size() != mSize) throw std::runtime_error("Incompatible sizes.");
+        Vector x(mSize, 0.0);
+        Vector r = b;
+        Vector p = r;
+        double rr = r * r;
+        double stop = tolerance * tolerance * rr;
+        for (int it = 0; it < 2 * mSize && rr > stop; ++it) {
+            Vector Ap = (*this) * p;
+            double alpha = rr / (p * Ap);
+            x = x + alpha * p;
+            r = r - alpha * Ap;
+            double rrNew = r * r;
+            p = r + (rrNew / rr) * p;
+            rr = rrNew;
+        }
+        return x;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const SymmetricMatrix& S) {
+        for (int i = 1; i <= S.mSize; ++i)
+            for (int j = 1; j <= S.mSize; ++j)
+                os << S(i, j) << (j == S.mSize ? "\n" : " ");
+        return os;
+    }
+};
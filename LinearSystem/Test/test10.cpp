@@ -0,0 +1,163 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include "../Matrix.hpp"
+#include "../Vector.hpp"
+#include "../LeastSquaresSystem.hpp"
+#include "../Resampling.hpp"
+
+const double kZ95 = 1.959963984540054;     // two-sided 95% normal quantile
+
+// y = A beta + noise, with an intercept column
+void makeData(int n, const std::vector<double>& beta, std::mt19937& g, Matrix& A, Vector& b) {
+    std::normal_distribution<double> N(0.0, 1.0);
+    int p = static_cast<int>(beta.size());
+    A = Matrix(n, p);
+    b = Vector(n, 0.0);
+    for (int i = 1; i <= n; ++i) {
+        A(i, 1) = 1.0;
+        for (int j = 2; j <= p; ++j) A(i, j) = N(g);
+        for (int j = 1; j <= p; ++j) b(i) += A(i, j) * beta[j - 1];
+        b(i) += 0.5 * N(g);
+    }
+}
+
+bool sameResult(const ResamplingResult& a, const ResamplingResult& b) {
+    if (a.coef.size() != b.coef.size() || a.skipped != b.skipped) return false;
+    for (size_t j = 0; j < a.coef.size(); ++j)
+        if (a.coef[j].lower != b.coef[j].lower || a.coef[j].upper != b.coef[j].upper) return false;
+    return a.rmse.lower == b.rmse.lower && a.rmse.upper == b.rmse.upper;
+}
+
+int main() {
+    std::cout << "=== Resampling Test ===\n";
+    const std::vector<double> beta = {2.0, -1.0, 0.5};
+    std::mt19937 g(5);
+
+    // The same seed gives the same bits on any number of threads
+    {
+        Matrix A;
+        Vector b;
+        makeData(300, beta, g, A, b);
+        Resampling resampling(A, b, 0.1);
+        Parallel::setThreads(1);
+        ResamplingResult boot1 = resampling.bootstrap(2000, 42);
+        ResamplingResult jack1 = resampling.jackknife();
+        Parallel::setThreads(4);
+        ResamplingResult boot4 = resampling.bootstrap(2000, 42);
+        ResamplingResult jack4 = resampling.jackknife();
+        Parallel::setThreads(0);
+        std::cout << "\nBootstrap, 1 vs 4 threads: " << (sameResult(boot1, boot4) ? "bitwise identical" : "DIFFERENT") << "\n";
+        std::cout << "Jackknife, 1 vs 4 threads: " << (sameResult(jack1, jack4) ? "bitwise identical" : "DIFFERENT") << "\n";
+    }
+
+    // 95% percentile intervals should contain the true coefficients about 95% of the time
+    {
+        const int datasets = 200;
+        std::vector<int> covered(beta.size(), 0);
+        for (int d = 0; d < datasets; ++d) {
+            Matrix A;
+            Vector b;
+            makeData(100, beta, g, A, b);
+            ResamplingResult ci = Resampling(A, b).bootstrap(400, d);
+            for (size_t j = 0; j < beta.size(); ++j)
+                if (ci.coef[j].lower <= beta[j] && beta[j] <= ci.coef[j].upper) ++covered[j];
+        }
+        bool ok = true;
+        std::cout << "\nBootstrap coverage of the true coefficients (" << datasets << " data sets, nominal 95%):\n";
+        for (size_t j = 0; j < beta.size(); ++j) {
+            double rate = static_cast<double>(covered[j]) / datasets;
+            ok = ok && rate >= 0.88 && rate <= 0.99;
+            std::cout << "  x" << j + 1 << ": " << 100.0 * rate << "%\n";
+        }
+        std::cout << "Within 88%..99%: " << (ok ? "yes" : "NO") << "\n";
+    }
+
+    // Jackknife standard error against explicit leave-one-out refits
+    {
+        const int n = 60;
+        const double lambda = 0.5;
+        Matrix A;
+        Vector b;
+        makeData(n, beta, g, A, b);
+        ResamplingResult jack = Resampling(A, b, lambda).jackknife();
+
+        int p = A.cols();
+        std::vector<Vector> fits;
+        for (int left = 1; left <= n; ++left) {
+            Matrix Ai(n - 1, p);
+            Vector bi(n - 1, 0.0);
+            for (int i = 1, k = 1; i <= n; ++i) {
+                if (i == left) continue;
+                for (int j = 1; j <= p; ++j) Ai(k, j) = A(i, j);
+                bi(k++) = b(i);
+            }
+            fits.push_back(LeastSquaresSystem(&Ai, &bi, lambda).solve());
+        }
+        double worst = 0.0;
+        for (int j = 1; j <= p; ++j) {
+            double mean = 0.0, ss = 0.0;
+            for (const Vector& x : fits) mean += x(j) / n;
+            for (const Vector& x : fits) ss += (x(j) - mean) * (x(j) - mean);
+            double se = std::sqrt((n - 1.0) / n * ss);
+            double reported = (jack.coef[j - 1].upper - jack.coef[j - 1].lower) / (2.0 * kZ95);
+            worst = std::max(worst, std::fabs(reported - se) / se);
+        }
+        std::cout << "\nJackknife SE vs " << n << " explicit refits, max relative difference: "
+                  << (worst < 1e-8 ? "< 1e-8" : std::to_string(worst)) << "\n";
+    }
+
+    // lambda = 0 and a column used by a single row: every resample that misses
+    // that row is singular and is skipped instead of aborting the run
+    {
+        const int n = 20;
+        Matrix A(n, 3);
+        Vector b(n, 0.0);
+        std::normal_distribution<double> N(0.0, 1.0);
+        for (int i = 1; i <= n; ++i) {
+            A(i, 1) = 1.0;
+            A(i, 2) = N(g);
+            A(i, 3) = (i == 1);
+            b(i) = 1.0 + 2.0 * A(i, 2) + 0.1 * N(g);
+        }
+        Resampling resampling(A, b);
+        ResamplingResult boot = resampling.bootstrap(1000, 3);
+        ResamplingResult jack = resampling.jackknife();
+        bool finite = true;
+        for (const Interval& c : boot.coef) finite = finite && std::isfinite(c.lower) && std::isfinite(c.upper);
+        for (const Interval& c : jack.coef) finite = finite && std::isfinite(c.lower) && std::isfinite(c.upper);
+        std::cout << "\nSingular resamples with lambda = 0:\n";
+        std::cout << "  bootstrap skipped " << boot.skipped << " of " << boot.resamples
+                  << " (expected about " << static_cast<int>(1000 * std::pow(1.0 - 1.0 / n, n)) << ")\n";
+        std::cout << "  jackknife skipped " << jack.skipped << " of " << jack.resamples << "\n";
+        std::cout << "  intervals finite: " << (finite ? "yes" : "NO") << "\n";
+        std::cout << "  x2: [" << boot.coef[1].lower << ", " << boot.coef[1].upper << "]\n";
+    }
+
+    // Same, but without row 1 column 3 is 0.3 * column 2 up to rounding: those resamples are
+    // singular in exact arithmetic and round-off leaves pivots of either sign
+    {
+        const int n = 20;
+        Matrix A(n, 3);
+        Vector b(n, 0.0);
+        std::normal_distribution<double> N(0.0, 1.0);
+        for (int i = 1; i <= n; ++i) {
+            A(i, 1) = 1.0;
+            A(i, 2) = N(g);
+            A(i, 3) = 0.3 * A(i, 2) + (i == 1);
+            b(i) = 1.0 + 2.0 * A(i, 2) + 0.1 * N(g);
+        }
+        ResamplingResult boot = Resampling(A, b).bootstrap(1000, 3);
+        bool narrow = true;
+        for (const Interval& c : boot.coef) narrow = narrow && c.upper - c.lower < 1.0;
+        std::cout << "\nNearly singular resamples with lambda = 0:\n";
+        std::cout << "  bootstrap skipped " << boot.skipped << " of " << boot.resamples
+                  << " (expected about " << static_cast<int>(1000 * std::pow(1.0 - 1.0 / n, n)) << ")\n";
+        std::cout << "  intervals narrower than 1: " << (narrow ? "yes" : "NO") << "\n";
+        std::cout << "  x3: [" << boot.coef[2].lower << ", " << boot.coef[2].upper << "]\n";
+    }
+
+    std::cout << "\n=== Test Completed ===\n";
+    return 0;
+}
@@ -1,9 +1,21 @@
 #include <iostream>
+#include <cmath>
 #include "../Matrix.hpp"
 #include "../Vector.hpp"
 #include "../LinearSystem.hpp"
 #include "../PosSymLinSystem.hpp"
 #include "../LeastSquaresSystem.hpp"
+#include "../SymmetricMatrix.hpp"
+#include "../SolverPolicy.hpp"
+
+// Print which solver the policy picked and why
+void report(const std::string& label, const Vector& x, const Vector& expected) {
+    const SolverDecision& d = SolverPolicy::last();
+    double err = 0.0;
+    for (int i = 1; i <= x.size(); ++i) err = std::max(err, std::abs(x(i) - expected(i)));
+    std::cout << label << ": " << SolverPolicy::name(d.method) << " (" << d.reason << "), rcond ~ "
+              << d.rcond << ", max error " << (err < 1e-6 ? "< 1e-6" : std::to_string(err)) << "\n";
+}
 
 int main() {
     std::cout << "=== LinearSystem Test ===\n";
@@ -31,7 +43,23 @@ int main() {
         Vector b = {1, 2, 3};
         PosSymLinSystem spdSys(&A, &b);
         Vector x = spdSys.solve();
-        std::cout << "Solution x (Conjugate Gradient):\n" << x;
+        std::cout << "Solution x (" << SolverPolicy::name(SolverPolicy::last().method) << "):\n" << x;
+    }
+
+    std::cout << "\n=== PosSymLinSystem Test (packed SymmetricMatrix) ===\n";
+    {
+        // Same SPD matrix, only the lower triangle is stored
+        SymmetricMatrix S(3);
+        S(1, 1) = 4;
+        S(2, 1) = 1; S(2, 2) = 3;
+        S(3, 1) = 1; S(3, 2) = 0; S(3, 3) = 2;
+        Vector b = {1, 2, 3};
+        PosSymLinSystem spdSys(&S, &b);
+        Vector x = spdSys.solve();
+        std::cout << "Solution x (" << SolverPolicy::name(SolverPolicy::last().method) << "):\n" << x;
+
+        TriangularMatrix L = S.cholesky();
+        std::cout << "Solution x (Cholesky):\n" << L.transposeSolve(L.solve(b));
     }
 
     std::cout << "\n=== LeastSquaresSystem Test (Overdetermined) ===\n";
@@ -47,6 +75,89 @@ int main() {
         LeastSquaresSystem lsqSys(&A, &b);
         Vector x = lsqSys.solve();
         std::cout << "Least Squares solution x:\n" << x;
+
+        LeastSquaresSystem ridgeSys(&A, &b, 1.0);
+        std::cout << "Ridge (lambda = 1) solution x:\n" << ridgeSys.solve();
+    }
+
+    std::cout << "\n=== SolverPolicy Test ===\n";
+    {
+        // Non-symmetric, well conditioned
+        DECLARE_MATRIX(A,
+            {4, 1, 0},
+            {2, 5, 1},
+            {0, 3, 6}
+        );
+        Vector x0 = {1, -2, 3};
+        Vector b = A * x0;
+        report("Non-symmetric 3x3", SolverPolicy::solve(A, b), x0);
+
+        // Hilbert matrix: SPD but cond ~ 1e13 at n = 10
+        int n = 10;
+        Matrix H(n, n);
+        Vector h0(n, 1.0);
+        for (int i = 1; i <= n; ++i)
+            for (int j = 1; j <= n; ++j) H(i, j) = 1.0 / (i + j - 1);
+        Vector hb = H * h0;
+        Vector hx = SolverPolicy::solve(H, hb);
+        const SolverDecision& d = SolverPolicy::last();
+        std::cout << "Hilbert 10x10: " << SolverPolicy::name(d.method) << " (" << d.reason << "), rcond ~ " << d.rcond << "\n";
+
+        // Packed SPD (AR(1) correlation): Cholesky runs on the packed triangle, and its
+        // condition estimate should agree with Eigen's on the dense copy
+        SymmetricMatrix C(50);
+        Vector c0(50, 1.0);
+        for (int i = 1; i <= 50; ++i)
+            for (int j = 1; j <= i; ++j) C(i, j) = std::pow(0.9, i - j);
+        Vector cx = SolverPolicy::solve(C, C * c0);
+        double packedRcond = SolverPolicy::last().rcond;
+        report("Packed SPD 50x50", cx, c0);
+        SolverPolicy::solve(C.toMatrix(), C * c0);
+        std::cout << "  rcond packed " << packedRcond << ", dense " << SolverPolicy::last().rcond << "\n";
+        SolverPolicy::solve(SymmetricMatrix::fromLower(H), hb);
+        std::cout << "Hilbert 10x10 (packed): " << SolverPolicy::name(SolverPolicy::last().method)
+                  << " (" << SolverPolicy::last().reason << ")\n";
+
+        // Singular: third row = first + second; b is consistent, SVD gives the minimum-norm solution
+        DECLARE_MATRIX(S,
+            {1, 2, 3},
+            {4, 5, 6},
+            {5, 7, 9}
+        );
+        Vector sb = {6, 15, 21};
+        Vector sx = SolverPolicy::solve(S, sb);
+        Vector r = S * sx - sb;
+        double residual = std::sqrt(r * r);
+        std::cout << "Singular 3x3: " << SolverPolicy::name(SolverPolicy::last().method)
+                  << " (" << SolverPolicy::last().reason << "), residual " << (residual < 1e-9 ? "< 1e-9" : std::to_string(residual)) << "\n";
+
+        // Large sparse SPD: 1D Laplacian plus identity
+        int m = 500;
+        Matrix T(m, m);
+        Vector t0(m, 0.0);
+        for (int i = 1; i <= m; ++i) {
+            T(i, i) = 3.0;
+            if (i > 1) T(i, i - 1) = T(i - 1, i) = -1.0;
+            t0(i) = std::sin(0.1 * i);
+        }
+        Vector tb = T * t0;
+        report("Tridiagonal 500x500", SolverPolicy::solve(T, tb), t0);
+
+        // Overdetermined, full rank: normal equations are safe
+        DECLARE_MATRIX(O,
+            {1, 1},
+            {1, 2},
+            {1, 3},
+            {1, 4}
+        );
+        Vector ob = {6, 5, 7, 10};
+        Vector reference = SolverPolicy::leastSquares(O, ob, SolverMethod::SVD);
+        report("Overdetermined 4x2", SolverPolicy::leastSquares(O, ob), reference);
+
+        // Log every decision
+        SolverPolicy::setLog(&std::cout);
+        SolverPolicy::solve(A, b);
+        SolverPolicy::setLog(nullptr);
     }
 
     std::cout << "\n=== Test Completed ===\n";
@@ -0,0 +1,168 @@
+#include <iostream>
+#include <random>
+#include <chrono>
+#include <vector>
+#include <cmath>
+#include "../Matrix.hpp"
+#include "../Vector.hpp"
+#include "../LinearSystem.hpp"
+#include "../LeastSquaresSystem.hpp"
+#include "../BatchedLinearSystem.hpp"
+
+// Random diagonally dominant system so that every instance is well-conditioned
+void randomSystem(std::mt19937& g, int n, Matrix& A, Vector& b) {
+    std::uniform_real_distribution<double> u(-1.0, 1.0);
+    for (int i = 1; i <= n; ++i) {
+        for (int j = 1; j <= n; ++j) A(i, j) = u(g);
+        A(i, i) += n;
+        b(i) = u(g);
+    }
+}
+
+int main() {
+    std::mt19937 g(42);
+
+    std::cout << "=== BatchedLinearSystem Test (LU) ===\n";
+    {
+        const int count = 20, n = 5;
+        std::vector<Matrix> As;
+        std::vector<Vector> bs;
+        BatchedLinearSystem batch(count, n);
+        for (int k = 1; k <= count; ++k) {
+            As.emplace_back(n, n);
+            bs.emplace_back(n, 0.0);
+            randomSystem(g, n, As.back(), bs.back());
+            batch.setSystem(k, As.back(), bs.back());
+        }
+        batch.solve();
+
+        double maxErr = 0.0;
+        for (int k = 1; k <= count; ++k) {
+            LinearSystem sys(&As[k - 1], &bs[k - 1]);
+            Vector diff = sys.solve() - batch.solution(k);
+            for (int i = 1; i <= n; ++i) maxErr = std::max(maxErr, std::abs(diff(i)));
+        }
+        std::cout << "Max difference to LinearSystem: " << (maxErr < 1e-10 ? "< 1e-10" : std::to_string(maxErr)) << "\n";
+    }
+
+    std::cout << "\n=== BatchedLinearSystem Test (Cholesky, least squares) ===\n";
+    {
+        DECLARE_MATRIX(A,
+            {1, 1},
+            {1, 2},
+            {1, 3},
+            {1, 4}
+        );
+        Vector b = {6, 5, 7, 10};
+        BatchedLinearSystem batch(3, 2);
+        for (int k = 1; k <= 3; ++k) batch.setLeastSquares(k, A, b);
+        batch.solve(BatchedLinearSystem::Method::Cholesky);
+        std::cout << "Least Squares solution x (system 3):\n" << batch.solution(3);
+    }
+
+    std::cout << "\n=== Solve state ===\n";
+    {
+        Matrix A = {{4, 1}, {1, 3}};
+        Vector b = {1, 2};
+        BatchedLinearSystem batch(2, 2);
+        batch.setSystem(1, A, b);
+        batch.setSystem(2, A, b);
+        try {
+            batch.solution(1);
+            std::cout << "solution() before solve(): no error\n";
+        } catch (const std::runtime_error&) {
+            std::cout << "solution() before solve(): error reported\n";
+        }
+        batch.solve();
+        Vector first = batch.solution(1);
+        batch.solve();   // nothing changed: no second factorization
+        std::cout << "Second solve() keeps the solution: " << ((batch.solution(1) - first).norm() == 0.0 ? "yes" : "no") << "\n";
+        try {
+            batch.solve(BatchedLinearSystem::Method::Cholesky);
+            std::cout << "Re-solve with another method: no error\n";
+        } catch (const std::runtime_error&) {
+            std::cout << "Re-solve with another method: error reported\n";
+        }
+        batch.setSystem(2, A, 2 * b);   // marks the batch dirty
+        std::cout << "Solved after setSystem(): " << (batch.solved() ? "yes" : "no") << "\n";
+        batch.setSystem(1, A, b);
+        batch.solve();
+        std::cout << "x2 after refill:\n" << batch.solution(2);
+    }
+
+    std::cout << "\n=== Partial refill and failed systems ===\n";
+    {
+        // 12 systems span a full block and a partial one; refill a few in each block
+        const int count = 12, n = 4;
+        std::vector<Matrix> As;
+        std::vector<Vector> bs;
+        BatchedLinearSystem batch(count, n);
+        for (int k = 1; k <= count; ++k) {
+            As.emplace_back(n, n);
+            bs.emplace_back(n, 0.0);
+            randomSystem(g, n, As.back(), bs.back());
+            batch.setSystem(k, As.back(), bs.back());
+        }
+        batch.solve();
+        for (int k : {2, 7, 10}) {
+            randomSystem(g, n, As[k - 1], bs[k - 1]);
+            batch.setSystem(k, As[k - 1], bs[k - 1]);
+        }
+        // System 5 becomes singular: its first two rows are equal
+        for (int j = 1; j <= n; ++j) As[4](2, j) = As[4](1, j);
+        batch.setSystem(5, As[4], bs[4]);
+        batch.solve();
+
+        double maxErr = 0.0;
+        for (int k = 1; k <= count; ++k) {
+            if (k == 5) continue;
+            LinearSystem sys(&As[k - 1], &bs[k - 1]);
+            Vector diff = sys.solve() - batch.solution(k);
+            for (int i = 1; i <= n; ++i) maxErr = std::max(maxErr, std::abs(diff(i)));
+        }
+        std::cout << "Refilled 2, 7, 10: every other solution still matches LinearSystem: "
+                  << (maxErr < 1e-10 ? "yes" : "no (" + std::to_string(maxErr) + ")") << "\n";
+        std::cout << "Failed systems:";
+        for (int k : batch.failed()) std::cout << " " << k;
+        std::cout << "\nok(5): " << (batch.ok(5) ? "yes" : "no") << ", ok(6): " << (batch.ok(6) ? "yes" : "no") << "\n";
+        try {
+            batch.solution(5);
+            std::cout << "solution(5): no error\n";
+        } catch (const std::runtime_error&) {
+            std::cout << "solution(5): error reported\n";
+        }
+    }
+
+    std::cout << "\n=== Throughput (systems/s) ===\n";
+    for (int n : {4, 8, 16, 32}) {
+        const int count = 4000000 / (n * n * n) + 64;
+        std::vector<Matrix> As;
+        std::vector<Vector> bs;
+        for (int k = 0; k < count; ++k) {
+            As.emplace_back(n, n);
+            bs.emplace_back(n, 0.0);
+            randomSystem(g, n, As.back(), bs.back());
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < count; ++k) {
+            LinearSystem sys(&As[k], &bs[k]);
+            sys.solve();
+        }
+        auto t1 = std::chrono::steady_clock::now();
+
+        BatchedLinearSystem batch(count, n);
+        for (int k = 1; k <= count; ++k) batch.setSystem(k, As[k - 1], bs[k - 1]);
+        auto t2 = std::chrono::steady_clock::now();
+        batch.solve();
+        auto t3 = std::chrono::steady_clock::now();
+
+        double single = count / std::chrono::duration<double>(t1 - t0).count();
+        double batched = count / std::chrono::duration<double>(t3 - t2).count();
+        std::cout << n << "x" << n << ": LinearSystem " << single << ", batched LU " << batched
+                  << " (x" << batched / single << ", " << Parallel::threads() << " threads)\n";
+    }
+
+    std::cout << "\n=== Test Completed ===\n";
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include "../Matrix.hpp"
+#include "../Vector.hpp"
+#include "../LeastSquaresSystem.hpp"
+#include "../FeaturePipeline.hpp"
+#include "../LinearModel.hpp"
+
+int main() {
+    std::vector<std::vector<double>> rows = {
+        {1, 2}, {2, 1}, {3, 5}, {4, 3}, {5, 8}, {6, 4}
+    };
+    std::vector<double> y = {3, 4, 9, 8, 14, 11};
+
+    std::cout << "=== FeaturePipeline Test ===\n";
+    {
+        FeaturePipeline fp;
+        fp.add<InteractionStage>().add<InterceptStage>();
+        fp.fit(rows);
+        std::cout << "Interactions + intercept of the first two rows:\n";
+        std::vector<std::vector<double>> head(rows.begin(), rows.begin() + 2);
+        std::cout << fp.transform(head);
+    }
+
+    std::cout << "\n=== Fused normal equations vs LeastSquaresSystem ===\n";
+    {
+        FeaturePipeline fp;
+        fp.add<ZScoreStage>().add<PolynomialStage>(2).add<InterceptStage>();
+        LinearModel model(std::move(fp));
+        Vector x = model.fit(rows, y, 0.5);
+
+        Matrix Z = model.pipeline().transform(rows);
+        Vector b(static_cast<int>(y.size()), 0.0);
+        for (int i = 1; i <= b.size(); ++i) b(i) = y[i - 1];
+        LeastSquaresSystem lss(&Z, &b, 0.5);
+        Vector diff = lss.solve() - x;
+        double maxErr = 0.0;
+        for (int i = 1; i <= diff.size(); ++i) maxErr = std::max(maxErr, std::abs(diff(i)));
+        std::cout << "Number of expanded features: " << x.size() << "\n";
+        std::cout << "Max coefficient difference: " << (maxErr < 1e-9 ? "< 1e-9" : std::to_string(maxErr)) << "\n";
+
+        model.save("test4_model.txt");
+        LinearModel loaded = LinearModel::load("test4_model.txt");
+        std::cout << "Prediction for (7, 6): " << model.predict({7, 6})
+                  << ", after reload: " << loaded.predict({7, 6}) << "\n";
+
+        try {
+            model.predict({7});
+            std::cout << "Prediction for a short row: no error\n";
+        } catch (const std::invalid_argument&) {
+            std::cout << "Prediction for a short row: error reported\n";
+        }
+
+        // The same file cut off in the middle of the z-score parameters
+        std::string text;
+        {
+            std::ifstream is("test4_model.txt");
+            std::stringstream ss;
+            ss << is.rdbuf();
+            text = ss.str();
+        }
+        std::ofstream("test4_model.txt") << text.substr(0, text.find("zscore") + 20);
+        try {
+            LinearModel::load("test4_model.txt");
+            std::cout << "Truncated model file: no error\n";
+        } catch (const std::runtime_error&) {
+            std::cout << "Truncated model file: error reported\n";
+        }
+        std::remove("test4_model.txt");
+    }
+
+    std::cout << "\n=== Test Completed ===\n";
+    return 0;
+}
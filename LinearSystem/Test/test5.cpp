@@ -0,0 +1,109 @@
+#include <iostream>
+#include <vector>
+#include "../Matrix.hpp"
+#include "../Vector.hpp"
+#include "../Allocator.hpp"
+#include "../SymmetricMatrix.hpp"
+#include "../TriangularMatrix.hpp"
+#include "../LeastSquaresSystem.hpp"
+
+int main() {
+    std::cout << "=== Scratch Arena Test ===\n";
+
+    NAMED_MATRIX(A, 40, 6);
+    Vector b(40, 0.0);
+    for (int i = 1; i <= 40; ++i) {
+        for (int j = 1; j <= 6; ++j) A(i, j) = 1.0 / (i + j) + (i == j);
+        b(i) = i % 7;
+    }
+    LeastSquaresSystem lss(&A, &b, 0.1);
+
+    std::cout << "\nHeap allocator calls per ridge solve:\n";
+    for (int call = 1; call <= 3; ++call) {
+        AllocStats::reset();
+        Vector x = lss.solve();
+        std::cout << "solve #" << call << ": " << AllocStats::heapCalls()
+                  << " heap, " << AllocStats::arenaCalls() << " arena\n";
+    }
+    std::cout << "(the one remaining heap call is the returned solution)\n";
+
+    std::cout << "\nSame solves into caller-provided storage:\n";
+    Vector xs(A.cols(), 0.0);
+    for (int call = 1; call <= 3; ++call) {
+        AllocStats::reset();
+        lss.solve(xs);
+        std::cout << "solve #" << call << ": " << AllocStats::heapCalls() << " heap\n";
+    }
+
+    std::cout << "\nSame solves inside a caller-owned ScratchScope:\n";
+    for (int call = 1; call <= 3; ++call) {
+        AllocStats::reset();
+        {
+            ScratchScope scratch;
+            Vector x = lss.solve();
+        }
+        std::cout << "solve #" << call << ": " << AllocStats::heapCalls() << " heap\n";
+    }
+
+    std::cout << "\nArena capacity: " << ScratchArena::local().capacity() << " bytes\n";
+
+    std::cout << "\nDeterminant of A^T A (copy made in the arena): ";
+    AllocStats::reset();
+    double d = (A.transpose() * A).det();
+    std::cout << d << " (" << AllocStats::heapCalls() << " heap calls: A^T and A^T A)\n";
+
+    // Objects moved out of a scope own heap copies, so reusing the arena cannot overwrite them
+    std::cout << "\nMoving results out of a ScratchScope:\n";
+    {
+        std::vector<Vector> keptVectors;
+        std::vector<Matrix> keptMatrices;
+        Matrix assigned(3, 3);
+        {
+            ScratchScope scratch;
+            Vector v(500, 2.0);
+            Matrix m(20, 20);
+            Matrix n(3, 3);
+            for (int i = 1; i <= 20; ++i) m(i, i) = 3.0;
+            n(2, 2) = 4.0;
+            keptVectors.push_back(std::move(v));
+            keptMatrices.push_back(std::move(m));
+            assigned = std::move(n);
+        }
+        {
+            ScratchScope scratch;   // same arena memory, filled with other values
+            Vector junk(500, -1.0);
+            Matrix junk2(20, 20);
+            for (int i = 1; i <= 20; ++i) junk2(i, i) = -1.0;
+        }
+        bool intact = assigned(2, 2) == 4.0;
+        for (int i = 1; i <= 500; ++i) intact = intact && keptVectors[0](i) == 2.0;
+        for (int i = 1; i <= 20; ++i) intact = intact && keptMatrices[0](i, i) == 3.0;
+        std::cout << "Moved vector/matrices intact after the arena is reused: " << (intact ? "yes" : "NO") << "\n";
+    }
+
+    // Same for the packed types: a Gram matrix assigned and a Cholesky factor constructed in a scope
+    {
+        Matrix M(30, 30);
+        for (int i = 1; i <= 30; ++i) M(i, i) = 4.0;
+        SymmetricMatrix G;
+        std::vector<TriangularMatrix> factors;
+        {
+            ScratchScope scratch;
+            G = SymmetricMatrix::fromLower(M);
+            TriangularMatrix L = G.cholesky();
+            factors.push_back(std::move(L));
+        }
+        {
+            ScratchScope scratch;
+            SymmetricMatrix junk = SymmetricMatrix::fromLower(-1.0 * M);
+            TriangularMatrix junk2(30);
+            for (int i = 1; i <= 30; ++i) junk2(i, i) = -1.0;
+        }
+        bool intact = true;
+        for (int i = 1; i <= 30; ++i) intact = intact && G(i, i) == 4.0 && factors[0](i, i) == 2.0;
+        std::cout << "Moved packed symmetric/triangular matrices intact after the arena is reused: " << (intact ? "yes" : "NO") << "\n";
+    }
+
+    std::cout << "\n=== Test Completed ===\n";
+    return 0;
+}
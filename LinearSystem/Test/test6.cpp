@@ -0,0 +1,86 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "../Matrix.hpp"
+#include "../Vector.hpp"
+#include "../LeastSquaresSystem.hpp"
+#include "../IncrementalLeastSquares.hpp"
+
+// Ridge solution on a subset of columns, the slow way
+Vector directFit(const Matrix& X, const Vector& y, const std::vector<int>& cols, double lambda) {
+    Matrix Xs(X.rows(), static_cast<int>(cols.size()));
+    for (int i = 1; i <= X.rows(); ++i)
+        for (size_t j = 0; j < cols.size(); ++j) Xs(i, j + 1) = X(i, cols[j]);
+    Vector ys = y;
+    LeastSquaresSystem lss(&Xs, &ys, lambda);
+    return lss.solve();
+}
+
+void printColumns(const std::string& label, const std::vector<int>& cols) {
+    std::cout << label;
+    for (int c : cols) std::cout << " " << c;
+    std::cout << "\n";
+}
+
+int main() {
+    // y depends on columns 1 (intercept), 3, 5 and 8 of 10
+    const int n = 200, p = 10;
+    std::mt19937 g(7);
+    std::normal_distribution<double> N(0.0, 1.0);
+    Matrix X(n, p);
+    Vector y(n, 0.0);
+    for (int i = 1; i <= n; ++i) {
+        X(i, 1) = 1.0;
+        for (int j = 2; j <= p; ++j) X(i, j) = N(g);
+        y(i) = 2.0 + 3.0 * X(i, 3) - 2.0 * X(i, 5) + 0.5 * X(i, 8) + 0.1 * N(g);
+    }
+    const double lambda = 0.1;
+
+    std::cout << "=== IncrementalLeastSquares Test ===\n";
+    {
+        IncrementalLeastSquares model(X, y, lambda);
+        for (int col : {1, 2, 3, 4, 5}) model.addColumn(col);
+        model.removeColumn(2);
+        model.addColumn(8);
+        model.removeColumn(4);
+
+        Vector b = model.coefficients();
+        std::vector<int> cols = model.active();
+        Vector direct = directFit(X, y, cols, lambda);
+        double maxErr = 0.0;
+        for (size_t j = 0; j < cols.size(); ++j) maxErr = std::max(maxErr, std::abs(b(cols[j]) - direct(j + 1)));
+        printColumns("Active columns:", cols);
+        std::cout << "Max difference to LeastSquaresSystem: " << (maxErr < 1e-9 ? "< 1e-9" : std::to_string(maxErr)) << "\n";
+    }
+
+    // Only the true columns may be selected; 2, 4, 6, 7, 9 and 10 are pure noise
+    const std::vector<int> truth = {1, 3, 5, 8};
+    bool passed = true;
+
+    std::cout << "\n=== Forward stepwise ===\n";
+    {
+        IncrementalLeastSquares model(X, y, lambda);
+        printColumns("Added:", model.forwardStepwise(p));
+        Vector b = model.coefficients();
+        std::cout << "Coefficients:\n" << b;
+        std::vector<int> selected = model.active();
+        std::sort(selected.begin(), selected.end());
+        std::cout << "Selected exactly 1 3 5 8: " << (selected == truth ? "yes" : "NO") << "\n";
+        passed = passed && selected == truth;
+    }
+
+    std::cout << "\n=== Backward elimination ===\n";
+    {
+        IncrementalLeastSquares model(X, y, lambda);
+        for (int col = 1; col <= p; ++col) model.addColumn(col);
+        printColumns("Dropped:", model.backwardElimination(1));
+        printColumns("Kept:", model.active());
+        std::cout << "Kept exactly 1 3 5 8: " << (model.active() == truth ? "yes" : "NO") << "\n";
+        passed = passed && model.active() == truth;
+    }
+
+    std::cout << "\n=== Test " << (passed ? "Completed" : "FAILED") << " ===\n";
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,221 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include "../Vector.hpp"
+#include "../VectorKernels.hpp"
+#include "../Matrix.hpp"
+#include "../SymmetricMatrix.hpp"
+#include "../Parallel.hpp"
+
+// Usage: ./test7 [max length]   (default 1e6; 1e8 needs about 2.4 GB)
+
+using Clock = std::chrono::steady_clock;
+using Variant = VectorKernels::Variant;
+
+// The loops Vector used before the kernels: one serial dependency chain
+double loopDot(const double* a, const double* b, size_t n) {
+    double result = 0.0;
+    for (size_t i = 0; i < n; ++i) result += a[i] * b[i];
+    return result;
+}
+
+void loopAxpy(double alpha, const double* x, const double* y, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = y[i] + alpha * x[i];
+}
+
+bool sameBits(double a, double b) { return std::memcmp(&a, &b, sizeof(double)) == 0; }
+
+// Dot product, Gram matrix and sum of squared differences with the current Parallel settings
+std::vector<double> reductions(const Vector& u, const Vector& v, const Matrix& A) {
+    std::vector<double> r;
+    r.push_back(u * v);
+    SymmetricMatrix G(A.cols());
+    G.rankUpdate(A);
+    for (int i = 1; i <= A.cols(); ++i)
+        for (int j = 1; j <= i; ++j) r.push_back(G(i, j));
+    const double* pu = u.data();
+    const double* pv = v.data();
+    r.push_back(Parallel::sum(u.size(), [pu, pv](int b, int e) { return VectorKernels::sumSqDiff(pu + b, pv + b, e - b); }));
+    return r;
+}
+
+// Repeat fn until about 0.2 s have passed; returns GB/s for `bytes` per call
+template <typename Fn>
+double gbPerSecond(size_t bytes, Fn&& fn) {
+    long long reps = 0;
+    Clock::time_point start = Clock::now();
+    double seconds = 0.0;
+    do {
+        fn();
+        ++reps;
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (seconds < 0.2);
+    return bytes * static_cast<double>(reps) / seconds / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxLength = argc > 1 ? static_cast<size_t>(std::stod(argv[1])) : 1000000;
+
+    std::vector<Variant> variants;
+    for (Variant v : {Variant::Scalar, Variant::SSE2, Variant::AVX2, Variant::AVX512})
+        if (VectorKernels::supported(v)) variants.push_back(v);
+    Variant best = VectorKernels::best();
+
+    std::cout << "=== VectorKernels Test ===\n";
+    std::cout << "Dispatched variant: " << VectorKernels::name(best) << "\n";
+
+    // Every variant must give bitwise identical reductions, for lengths around the block size too
+    {
+        bool identical = true;
+        for (size_t n : {0, 1, 15, 16, 17, 33, 1000, 4099}) {
+            std::vector<double> a(n), b(n);
+            for (size_t i = 0; i < n; ++i) {
+                a[i] = std::sin(0.37 * i) * 1e3;
+                b[i] = 1.0 / (i + 1.0);
+            }
+            VectorKernels::setVariant(Variant::Scalar);
+            double dot = VectorKernels::dot(a.data(), b.data(), n);
+            double ssd = VectorKernels::sumSqDiff(a.data(), b.data(), n);
+            for (Variant v : variants) {
+                VectorKernels::setVariant(v);
+                double d = VectorKernels::dot(a.data(), b.data(), n);
+                double s = VectorKernels::sumSqDiff(a.data(), b.data(), n);
+                if (std::memcmp(&d, &dot, sizeof(double)) != 0 || std::memcmp(&s, &ssd, sizeof(double)) != 0)
+                    identical = false;
+            }
+        }
+        VectorKernels::setVariant(best);
+        std::cout << "Reductions bitwise identical across variants: " << (identical ? "yes" : "NO") << "\n";
+
+        // setVariant while other threads are inside the kernels: every call sees one whole table
+        std::vector<double> a(4099), b(4099);
+        for (size_t i = 0; i < a.size(); ++i) {
+            a[i] = std::cos(0.11 * i);
+            b[i] = i % 7 - 3.0;
+        }
+        double expected = VectorKernels::dot(a.data(), b.data(), a.size());
+        std::atomic<bool> running(true), changed(false);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; ++t) {
+            workers.emplace_back([&] {
+                while (running)
+                    if (!sameBits(VectorKernels::dot(a.data(), b.data(), a.size()), expected)) changed = true;
+            });
+        }
+        for (int k = 0; k < 2000; ++k) VectorKernels::setVariant(variants[k % variants.size()]);
+        running = false;
+        for (auto& w : workers) w.join();
+        VectorKernels::setVariant(best);
+        std::cout << "Switching variants while 4 threads run kernels, results unchanged: " << (changed ? "NO" : "yes") << "\n";
+
+        Vector x = {3, 4};
+        Vector y = {1, 2};
+        std::cout << "x * y = " << x * y << ", |x| = " << x.norm() << ", x - y = " << x - y;
+    }
+
+    std::cout << "\n=== Reproducible reductions ===\n";
+    {
+        int n = 1 << 20;
+        Vector u(n, 0.0), v(n, 0.0);
+        for (int i = 1; i <= n; ++i) {
+            u(i) = std::sin(0.001 * i) * 1e4;
+            v(i) = std::cos(0.37 * i) + 1e-3 * i;
+        }
+        Matrix A(20000, 12);
+        for (int i = 1; i <= A.rows(); ++i)
+            for (int j = 1; j <= A.cols(); ++j) A(i, j) = std::sin(0.1 * i * j) + j;
+
+        for (bool reproducible : {false, true}) {
+            Parallel::setReproducible(reproducible);
+            Parallel::setThreads(1);
+            std::vector<double> reference = reductions(u, v, A);
+            int differing = 0;
+            for (int threads : {2, 3, 4, 7, 8}) {
+                Parallel::setThreads(threads);
+                std::vector<double> r = reductions(u, v, A);
+                for (size_t k = 0; k < r.size(); ++k)
+                    if (!sameBits(r[k], reference[k])) { ++differing; break; }
+            }
+            std::cout << (reproducible ? "Reproducible" : "Default     ") << " mode, 2-8 threads vs 1 thread: "
+                      << (differing ? std::to_string(differing) + " of 5 thread counts differ" : "bitwise identical") << "\n";
+        }
+
+        // Cost of the fixed blocks with the machine's threads (best of 3 alternating runs)
+        Parallel::setThreads(0);
+        double rate[2] = {0.0, 0.0};
+        for (int rep = 0; rep < 3; ++rep) {
+            for (bool reproducible : {false, true}) {
+                Parallel::setReproducible(reproducible);
+                rate[reproducible] = std::max(rate[reproducible],
+                    gbPerSecond(sizeof(double) * (2.0 * n + A.rows() * A.cols()), [&] { reductions(u, v, A); }));
+            }
+        }
+        Parallel::setReproducible(false);
+        std::cout << "Reproducible / default throughput: " << std::setprecision(3) << rate[1] / rate[0] << "\n";
+    }
+
+    std::cout << "\n=== Throughput (GB/s) ===\n";
+    std::cout << std::setw(10) << "length" << std::setw(12) << "dot loop";
+    for (Variant v : variants) std::cout << std::setw(12) << (std::string("dot ") + VectorKernels::name(v));
+    std::cout << std::setw(12) << "axpy loop" << std::setw(12) << "axpy best" << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+
+    std::vector<size_t> lengths;
+    for (size_t n = 16; n < maxLength; n *= 8) lengths.push_back(n);
+    lengths.push_back(maxLength);
+
+    volatile double sink = 0.0;
+    for (size_t n : lengths) {
+        std::vector<double> a(n, 1.0), b(n, 0.5), out(n);
+        size_t dotBytes = 2 * sizeof(double) * n, axpyBytes = 3 * sizeof(double) * n;
+
+        std::cout << std::setw(10) << n;
+        std::cout << std::setw(12) << gbPerSecond(dotBytes, [&] { sink = sink + loopDot(a.data(), b.data(), n); });
+        for (Variant v : variants) {
+            VectorKernels::setVariant(v);
+            std::cout << std::setw(12) << gbPerSecond(dotBytes, [&] { sink = sink + VectorKernels::dot(a.data(), b.data(), n); });
+        }
+        VectorKernels::setVariant(best);
+        std::cout << std::setw(12) << gbPerSecond(axpyBytes, [&] { loopAxpy(0.5, a.data(), b.data(), out.data(), n); sink = sink + out[0]; });
+        std::cout << std::setw(12) << gbPerSecond(axpyBytes, [&] { VectorKernels::axpy(0.5, a.data(), b.data(), out.data(), n); sink = sink + out[0]; });
+        std::cout << "\n";
+    }
+
+    // Vector::operator* in default mode is one kernel call. Splitting it over threads
+    // (what Parallel::sum does) only adds overhead for a memory-bound pass, whether the
+    // threads come from the pool or are started per call.
+    std::cout << "\n=== Vector dot product, default mode (GB/s) ===\n";
+    std::cout << std::setw(10) << "length" << std::setw(12) << "kernel" << std::setw(12) << "u * v"
+              << std::setw(14) << "sum, 4 pool" << std::setw(16) << "sum, 4 spawned" << "\n";
+    Parallel::setThreads(4);
+    for (int n : {4096, 32768, 262144, 1 << 20}) {
+        Vector u(n, 1.0), v(n, 0.5);
+        const double* pu = u.data();
+        const double* pv = v.data();
+        auto part = [pu, pv](int begin, int end) { return VectorKernels::dot(pu + begin, pv + begin, end - begin); };
+        size_t bytes = 2 * sizeof(double) * n;
+        std::cout << std::setw(10) << n;
+        std::cout << std::setw(12) << gbPerSecond(bytes, [&] { sink = sink + VectorKernels::dot(pu, pv, n); });
+        std::cout << std::setw(12) << gbPerSecond(bytes, [&] { sink = sink + u * v; });
+        std::cout << std::setw(14) << gbPerSecond(bytes, [&] { sink = sink + Parallel::sum(n, part, 1024); });
+        std::cout << std::setw(16) << gbPerSecond(bytes, [&] {
+            double partial[4];
+            std::vector<std::thread> workers;
+            for (int t = 1; t < 4; ++t) workers.emplace_back([&, t] { partial[t] = part(n * t / 4, n * (t + 1) / 4); });
+            partial[0] = part(0, n / 4);
+            for (auto& w : workers) w.join();
+            sink = sink + partial[0] + partial[1] + partial[2] + partial[3];
+        });
+        std::cout << "\n";
+    }
+    Parallel::setThreads(0);
+
+    std::cout << "\n=== Test Completed ===\n";
+    return 0;
+}
@@ -0,0 +1,190 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include "../FeaturePipeline.hpp"
+#include "../LinearModel.hpp"
+#include "../ShardTrainer.hpp"
+
+const int kFeatures = 6;
+
+// "f1,...,f6,y"
+bool parseLine(const std::string& line, double* features, double& target) {
+    if (line.empty()) return false;
+    const char* p = line.c_str();
+    char* end;
+    for (int i = 0; i < kFeatures; ++i) {
+        features[i] = std::strtod(p, &end);
+        if (end == p || *end != ',') throw std::runtime_error("\n>> Error: Malformed line: " + line);
+        p = end + 1;
+    }
+    target = std::strtod(p, &end);
+    if (end == p) throw std::runtime_error("\n>> Error: Malformed line: " + line);
+    return true;
+}
+
+// Shards with y = 3 + x . w + noise; the shards have different feature scales
+std::vector<std::string> writeShards(int count, int rows) {
+    std::mt19937 g(11);
+    std::normal_distribution<double> N(0.0, 1.0);
+    const double w[kFeatures] = {1.5, -2.0, 0.5, 0.0, 4.0, -1.0};
+    std::vector<std::string> paths;
+    for (int k = 0; k < count; ++k) {
+        std::string path = "test8_shard" + std::to_string(k) + ".csv";
+        std::ofstream os(path);
+        os.precision(17);
+        for (int r = 0; r < rows; ++r) {
+            double y = 3.0 + 0.1 * N(g);
+            for (int j = 0; j < kFeatures; ++j) {
+                double x = (1.0 + 0.2 * k) * N(g) + j;
+                y += w[j] * x;
+                os << x << ",";
+            }
+            os << y << "\n";
+        }
+        paths.push_back(path);
+    }
+    return paths;
+}
+
+// The whole data set in memory, read with the same parser
+void loadShards(const std::vector<std::string>& paths, std::vector<std::vector<double>>& rows, std::vector<double>& targets) {
+    for (const std::string& path : paths) {
+        std::ifstream is(path);
+        std::string line;
+        std::vector<double> row(kFeatures);
+        double target;
+        while (std::getline(is, line)) {
+            if (!parseLine(line, row.data(), target)) continue;
+            rows.push_back(row);
+            targets.push_back(target);
+        }
+    }
+}
+
+FeaturePipeline makePipeline() {
+    FeaturePipeline pipeline;
+    pipeline.add<ZScoreStage>().add<InterceptStage>();
+    return pipeline;
+}
+
+// Two z-scores in a row: affine, but the second is fitted on the first's output, so the
+// trainer falls back to one extra pass per stage
+FeaturePipeline makeTwoPassPipeline() {
+    FeaturePipeline pipeline;
+    pipeline.add<ZScoreStage>().add<ZScoreStage>().add<InterceptStage>();
+    return pipeline;
+}
+
+bool sameCoefficients(const Vector& a, const Vector& b) {
+    if (a.size() != b.size()) return false;
+    for (int i = 1; i <= a.size(); ++i)
+        if (a(i) != b(i)) return false;
+    return true;
+}
+
+// Largest |a_i - b_i| / max(1, |b_i|)
+double relativeDifference(const Vector& a, const Vector& b) {
+    double worst = 0.0;
+    for (int i = 1; i <= a.size(); ++i)
+        worst = std::max(worst, std::abs(a(i) - b(i)) / std::max(1.0, std::abs(b(i))));
+    return worst;
+}
+
+int main() {
+    const int shards = 4, rowsPerShard = 50000;
+    const double lambda = 0.1;
+    std::vector<std::string> paths = writeShards(shards, rowsPerShard);
+    std::vector<std::vector<double>> allRows;
+    std::vector<double> allTargets;
+    loadShards(paths, allRows, allTargets);
+
+    std::cout << "=== ShardTrainer Test ===\n";
+    ShardTrainer trainer(kFeatures, parseLine, lambda, 2048, 4);
+    LinearModel pipelined = trainer.train(makePipeline(), paths);
+    TrainingReport pipelinedReport = trainer.report();
+    LinearModel serial = trainer.trainSerial(makePipeline(), paths);
+    TrainingReport serialReport = trainer.report();
+
+    // Reference: LinearModel::fit with every row in memory
+    LinearModel reference(makePipeline());
+    reference.fit(allRows, allTargets, lambda);
+
+    // The z-score is fitted in the training pass and applied to the raw Gram matrix afterwards,
+    // so the sums are rounded differently from the in-memory fit
+    double difference = relativeDifference(pipelined.coefficients(), reference.coefficients());
+    std::cout << "Rows trained: " << pipelinedReport.rows << ", fitted in the training pass: "
+              << (pipelinedReport.fitInTrainingPass ? "yes" : "no") << ", extra fit passes: " << pipelinedReport.fitPasses << "\n";
+    std::cout << "Pipelined == serial (bitwise): " << (sameCoefficients(pipelined.coefficients(), serial.coefficients()) ? "yes" : "no") << "\n";
+    std::cout << "Pipelined == LinearModel::fit in memory (relative difference < 1e-9): " << (difference < 1e-9 ? "yes" : "no") << "\n";
+    std::cout << "Coefficients:\n" << pipelined.coefficients();
+
+    // An empty first shard changes nothing
+    {
+        std::ofstream("test8_empty.csv").close();
+        std::vector<std::string> withEmpty = paths;
+        withEmpty.insert(withEmpty.begin(), "test8_empty.csv");
+        LinearModel model = trainer.train(makePipeline(), withEmpty);
+        std::remove("test8_empty.csv");
+        std::cout << "Empty first shard, same coefficients: " << (sameCoefficients(model.coefficients(), pipelined.coefficients()) ? "yes" : "no") << "\n";
+    }
+
+    // No stage needs statistics: no fit pass, straight to accumulating
+    {
+        FeaturePipeline plain;
+        plain.add<InterceptStage>();
+        LinearModel model = trainer.train(std::move(plain), paths);
+        int passes = trainer.report().fitPasses;
+        FeaturePipeline plainReference;
+        plainReference.add<InterceptStage>();
+        LinearModel expected(std::move(plainReference));
+        expected.fit(allRows, allTargets, lambda);
+        std::cout << "Intercept only: " << passes << " fit passes, same as LinearModel::fit: "
+                  << (sameCoefficients(model.coefficients(), expected.coefficients()) ? "yes" : "no") << "\n";
+    }
+
+    // Pipelines that cannot be fitted in the training pass stream the shards once per fitted stage
+    {
+        LinearModel model = trainer.train(makeTwoPassPipeline(), paths);
+        int passes = trainer.report().fitPasses;
+        LinearModel expected(makeTwoPassPipeline());
+        expected.fit(allRows, allTargets, lambda);
+        std::cout << "Two z-scores: " << passes << " extra fit passes, same as LinearModel::fit (bitwise): "
+                  << (sameCoefficients(model.coefficients(), expected.coefficients()) ? "yes" : "no") << "\n";
+    }
+
+    // A pipeline fitted on another width is rejected
+    try {
+        FeaturePipeline narrow = makePipeline();
+        std::vector<std::vector<double>> rows = {{1.0, 2.0}, {3.0, 5.0}};
+        narrow.fit(rows);
+        trainer.train(std::move(narrow), paths);
+        std::cout << "Pipeline fitted on 2 features: no error\n";
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Pipeline fitted on 2 features: error reported\n";
+    }
+
+    // A missing shard surfaces as an exception from train()
+    try {
+        std::vector<std::string> bad = paths;
+        bad.push_back("test8_missing.csv");
+        trainer.train(makePipeline(), bad);
+        std::cout << "Missing shard: no error\n";
+    } catch (const std::exception& e) {
+        std::cout << "Missing shard: error reported\n";
+    }
+
+    std::cout << "\n=== Stage metrics (times depend on the machine) ===\n";
+    serialReport.print(std::cout);
+    pipelinedReport.print(std::cout);
+
+    for (const std::string& path : paths) std::remove(path.c_str());
+    std::cout << "\n=== Test Completed ===\n";
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <functional>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include "../FeaturePipeline.hpp"
+#include "../KernelFeatures.hpp"
+#include "../LinearModel.hpp"
+
+// Usage: ./test9 [training rows]   (default 10000)
+
+using Clock = std::chrono::steady_clock;
+using Rows = std::vector<std::vector<double>>;
+
+const int kFeatures = 6;
+
+double seconds(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// y depends on x nonlinearly: a linear model can only pick up the x5 term
+void makeData(int n, std::mt19937& g, Rows& rows, std::vector<double>& targets) {
+    std::uniform_real_distribution<double> U(-2.0, 2.0);
+    std::normal_distribution<double> noise(0.0, 0.1);
+    for (int i = 0; i < n; ++i) {
+        std::vector<double> x(kFeatures);
+        for (double& v : x) v = U(g);
+        rows.push_back(x);
+        targets.push_back(std::sin(2.0 * x[0]) + x[1] * x[2] + 0.5 * std::cos(x[3]) * x[4] + 0.3 * x[5] + noise(g));
+    }
+}
+
+double rmse(const Vector& predictions, const std::vector<double>& targets) {
+    double s = 0.0;
+    for (int i = 1; i <= predictions.size(); ++i) {
+        double d = predictions(i) - targets[i - 1];
+        s += d * d;
+    }
+    return std::sqrt(s / predictions.size());
+}
+
+// Mean |z(x) . z(y) - exp(-gamma |x - y|^2)| over consecutive pairs of rows
+double kernelError(FeatureStage& stage, const Rows& fitRows, const Rows& rows, double gamma) {
+    stage.prepare(kFeatures);
+    if (stage.needsFit()) {
+        stage.beginFit(kFeatures);
+        for (const auto& r : fitRows) stage.observe(r.data());
+        stage.endFit();
+    }
+    int D = stage.outDim(kFeatures);
+    std::vector<double> a(D), b(D);
+    double total = 0.0;
+    int pairs = static_cast<int>(rows.size()) / 2;
+    for (int i = 0; i < pairs; ++i) {
+        const auto& x = rows[2 * i];
+        const auto& y = rows[2 * i + 1];
+        stage.apply(x.data(), kFeatures, a.data());
+        stage.apply(y.data(), kFeatures, b.data());
+        double approx = 0.0, d2 = 0.0;
+        for (int j = 0; j < D; ++j) approx += a[j] * b[j];
+        for (int k = 0; k < kFeatures; ++k) d2 += (x[k] - y[k]) * (x[k] - y[k]);
+        total += std::fabs(approx - std::exp(-gamma * d2));
+    }
+    return total / pairs;
+}
+
+template <typename Stage>
+void benchmark(const std::string& label, int D, double gamma, double lambda,
+               const Rows& train, const std::vector<double>& trainY,
+               const Rows& test, const std::vector<double>& testY) {
+    Stage standalone(D, gamma);
+    double kernelErr = kernelError(standalone, Rows(train.begin(), train.begin() + std::min<size_t>(train.size(), 5000)), test, gamma);
+
+    FeaturePipeline pipeline;
+    pipeline.add<ZScoreStage>();
+    pipeline.add(std::unique_ptr<FeatureStage>(new Stage(D, gamma)));
+    pipeline.add<InterceptStage>();
+    LinearModel model(std::move(pipeline));
+    Clock::time_point start = Clock::now();
+    model.fit(train, trainY, lambda);
+    double fitSeconds = seconds(start);
+
+    start = Clock::now();
+    Vector predictions = model.predict(test);
+    double usPerRow = seconds(start) / test.size() * 1e6;
+
+    std::cout << std::setw(9) << label << std::setw(6) << D << std::setw(13) << kernelErr
+              << std::setw(11) << rmse(predictions, testY) << std::setw(10) << fitSeconds
+              << std::setw(13) << usPerRow << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    int nTrain = argc > 1 ? std::stoi(argv[1]) : 10000;
+    const double gamma = 0.2, lambda = 1e-3;
+
+    std::mt19937 g(7);
+    Rows train, test;
+    std::vector<double> trainY, testY;
+    makeData(nTrain, g, train, trainY);
+    makeData(2000, g, test, testY);
+
+    std::cout << "=== Kernel Features Test ===\n";
+    std::cout << "Training rows: " << nTrain << ", test rows: " << test.size()
+              << ", RBF gamma: " << gamma << ", lambda: " << lambda << "\n";
+
+    // Same fit on one thread and on four, with the tiled Gram update
+    {
+        FeaturePipeline a, b;
+        a.add<ZScoreStage>().add<RandomFourierStage>(200, gamma).add<InterceptStage>();
+        b.add<ZScoreStage>().add<RandomFourierStage>(200, gamma).add<InterceptStage>();
+        LinearModel one(std::move(a)), all(std::move(b));
+        Parallel::setReproducible(true);
+        Parallel::setThreads(1);
+        one.fit(train, trainY, lambda);
+        Parallel::setThreads(4);
+        all.fit(train, trainY, lambda);
+        Parallel::setThreads(0);
+        Parallel::setReproducible(false);
+        bool same = true;
+        for (int j = 1; j <= one.coefficients().size(); ++j)
+            if (one.coefficients()(j) != all.coefficients()(j)) same = false;
+        std::cout << "Reproducible fit, 1 vs 4 threads: " << (same ? "bitwise identical" : "DIFFERENT") << "\n";
+
+        // Only the z-score stage needs the data; the Fourier frequencies are drawn up front
+        FeaturePipeline c;
+        c.add<ZScoreStage>().add<RandomFourierStage>(200, gamma).add<InterceptStage>();
+        int passes = 0;
+        c.fitStreaming(kFeatures, [&](const std::function<void(const double*, int)>& observe) {
+            ++passes;
+            for (const auto& r : train) observe(r.data(), 1);
+        });
+        std::cout << "Passes over the data to fit z-score + rff: " << passes << "\n";
+
+        all.save("test9_model.txt");
+        LinearModel loaded = LinearModel::load("test9_model.txt");
+        std::remove("test9_model.txt");
+        Vector p1 = all.predict(test), p2 = loaded.predict(test);
+        double maxDiff = 0.0;
+        for (int i = 1; i <= p1.size(); ++i) maxDiff = std::max(maxDiff, std::fabs(p1(i) - p2(i)));
+        std::cout << "Saved and loaded model, max prediction difference: " << maxDiff << "\n";
+    }
+
+    std::cout << "\n" << std::setw(9) << "features" << std::setw(6) << "D" << std::setw(13) << "kernel err"
+              << std::setw(11) << "test RMSE" << std::setw(10) << "fit s" << std::setw(13) << "predict us" << "\n";
+    std::cout << std::fixed;
+    {
+        FeaturePipeline pipeline;
+        pipeline.add<ZScoreStage>().add<InterceptStage>();
+        LinearModel linear(std::move(pipeline));
+        Clock::time_point start = Clock::now();
+        linear.fit(train, trainY, lambda);
+        double fitSeconds = seconds(start);
+        std::cout << std::setprecision(4) << std::setw(9) << "linear" << std::setw(6) << kFeatures + 1 << std::setw(13) << "-"
+                  << std::setw(11) << rmse(linear.predict(test), testY) << std::setw(10) << fitSeconds << std::setw(13) << "-" << "\n";
+    }
+    for (int D : {25, 50, 100, 200, 400, 800})
+        benchmark<RandomFourierStage>("rff", D, gamma, lambda, train, trainY, test, testY);
+    for (int D : {25, 50, 100, 200, 400, 800})
+        benchmark<NystromStage>("nystrom", D, gamma, lambda, train, trainY, test, testY);
+
+    std::cout << "\n=== Test Completed ===\n";
+    return 0;
+}
@@ -0,0 +1,110 @@
+// TriangularMatrix.hpp
+#pragma once
+#include "PackedMatrix.hpp"
+#include "Vector.hpp"
+
+// Lower or upper triangular n x n matrix. Both are stored as a packed lower triangle:
+// an upper matrix U keeps U^T, so transpose() only flips the flag.
+class TriangularMatrix : public PackedMatrix {
+public:
+    enum class Uplo { Lower, Upper };
+
+private:
+    Uplo mUplo;
+
+    // Solve P y = b in place, P = the stored lower triangle (row-oriented)
+    void forward(double* y) const {
+        for (int i = 0; i < mSize; ++i) {
+            const double* row = mData + index(i, 0);
+            double s = y[i];
+            for (int j = 0; j < i; ++j) s -= row[j] * y[j];
+            if (row[i] == 0.0) throw std::runtime_error("\nError: Triangular matrix is singular.");
+            y[i] = s / row[i];
+        }
+    }
+
+    // Solve P^T y = b in place (column-oriented over the rows of P)
+    void backward(double* y) const {
+        for (int i = mSize - 1; i >= 0; --i) {
+            const double* row = mData + index(i, 0);
+            if (row[i] == 0.0) throw std::runtime_error("\nError: Triangular matrix is singular.");
+            y[i] /= row[i];
+            double yi = y[i];
+            for (int j = 0; j < i; ++j) y[j] -= row[j] * yi;
+        }
+    }
+
+    void checkSize(const Vector& b) const {
+        if (b.size() != mSize) throw std::runtime_error("Incompatible sizes.");
+    }
+
+public:
+    TriangularMatrix(int n = 0, Uplo uplo = Uplo::Lower) : PackedMatrix(n), mUplo(uplo) {}
+
+    Uplo uplo() const { return mUplo; }
+    bool isLower() const { return mUplo == Uplo::Lower; }
+
+    // Access element (1-based); only the stored triangle is writable
+    double& operator()(int i, int j) {
+        checkIndex(i, j);
+        if (isLower() ? i < j : i > j)
+            throw std::out_of_range("\nError: The matrix index (" + std::to_string(i) + ", " + std::to_string(j) + ") is outside the triangle.");
+        return isLower() ? mData[index(i - 1, j - 1)] : mData[index(j - 1, i - 1)];
+    }
+
+    double operator()(int i, int j) const {
+        checkIndex(i, j);
+        if (isLower() ? i < j : i > j) return 0.0;
+        return isLower() ? mData[index(i - 1, j - 1)] : mData[index(j - 1, i - 1)];
+    }
+
+    TriangularMatrix transpose() const {
+        TriangularMatrix result(*this);
+        result.mUplo = isLower() ? Uplo::Upper : Uplo::Lower;
+        return result;
+    }
+
+    // T x = b by forward (lower) or backward (upper) substitution
+    Vector solve(const Vector& b) const {
+        checkSize(b);
+        Vector x = b;
+        if (isLower()) forward(x.data());
+        else backward(x.data());
+        return x;
+    }
+
+    // T^T x = b, without forming the transpose
+    Vector transposeSolve(const Vector& b) const {
+        checkSize(b);
+        Vector x = b;
+        if (isLower()) backward(x.data());
+        else forward(x.data());
+        return x;
+    }
+
+    // Triangular matrix-vector product
+    Vector operator*(const Vector& x) const {
+        checkSize(x);
+        Vector y(mSize, 0.0);
+        const double* px = x.data();
+        double* py = y.data();
+        for (int i = 0; i < mSize; ++i) {
+            const double* row = mData + index(i, 0);
+            if (isLower()) {
+                double s = 0.0;
+                for (int j = 0; j <= i; ++j) s += row[j] * px[j];
+                py[i] = s;
+            } else {
+                for (int j = 0; j <= i; ++j) py[j] += row[j] * px[i];
+            }
+        }
+        return y;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const TriangularMatrix& T) {
+        for (int i = 1; i <= T.mSize; ++i)
+            for (int j = 1; j <= T.mSize; ++j)
+                os << T(i, j) << (j == T.mSize ? "\n" : " ");
+        return os;
+    }
+};
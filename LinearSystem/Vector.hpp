@@ -3,7 +3,11 @@
 #include <iostream>
 #include <cstdlib>        // For exit()
 #include <initializer_list>
+#include <algorithm>
 #include <Eigen/Dense>
+#include "Allocator.hpp"
+#include "VectorKernels.hpp"
+#include "Parallel.hpp"
 using namespace std;
 
 static bool debug = false;
@@ -12,14 +16,30 @@ class Vector {
 private:
     int mSize;
     double* mData;  
+    Allocator* mAlloc;
+
+    // Storage comes from the allocator current at construction (heap, or a scratch arena)
+    void allocate(int s) {
+        mSize = s;
+        mData = s > 0 ? static_cast<double*>(mAlloc->allocate(sizeof(double) * s)) : nullptr;
+    }
+
+    void release() {
+        if (mData) mAlloc->deallocate(mData, sizeof(double) * mSize);
+        mData = nullptr;
+    }
+
+    // Uninitialized vector of size s, filled in by the operators below
+    struct Uninitialized {};
+    Vector(int s, Uninitialized) : mAlloc(Allocator::current()) { allocate(s); }
 
 public:
     // Default constructor
-    Vector() : mSize(0), mData(nullptr) {}
+    Vector() : mSize(0), mData(nullptr), mAlloc(Allocator::current()) {}
 
     // Constructor with user input
-    Vector(initializer_list<double> list) : mSize(list.size()) {
-        mData = new double[mSize];
+    Vector(initializer_list<double> list) : mAlloc(Allocator::current()) {
+        allocate(static_cast<int>(list.size()));
         int i = 0;
         for (auto val : list) {
             mData[i++] = val;
@@ -27,27 +47,32 @@ public:
     }
 
     // Constructor with deep copy
-    Vector(int s, const double* a) : mSize(s) {
-        mData = new double[mSize];
+    Vector(int s, const double* a) : mAlloc(Allocator::current()) {
+        allocate(s);
         for (int i = 0; i < mSize; ++i) mData[i] = a[i];
     }
 
     // Number-constructor
-    Vector(int s, const double a) : mSize(s) {
-        mData = new double[mSize];
+    Vector(int s, const double a) : mAlloc(Allocator::current()) {
+        allocate(s);
         for (int i = 0; i < mSize; ++i) mData[i] = a;
     }
 
     // Copy constructor
-    Vector(const Vector& other) {
-        mSize = other.mSize;
-        mData = new double[other.mSize];
+    Vector(const Vector& other) : mAlloc(Allocator::current()) {
+        allocate(other.mSize);
         for (int i = 0; i < mSize; ++i) mData[i] = other.mData[i];
     }
 
-    // Move constructor
+    // Move constructor (a scratch-arena buffer is copied to the heap, since the new vector may outlive the scope).
+    // Kept noexcept so std::vector<Vector> grows by moving: only that arena copy allocates, and if
+    // it throws bad_alloc the program terminates.
     Vector(Vector&& other) noexcept
-    : mSize(other.mSize), mData(other.mData) {
+    : mSize(other.mSize), mData(other.mData), mAlloc(Allocator::adoptable(other.mAlloc)) {
+        if (mAlloc != other.mAlloc) {
+            allocate(other.mSize);
+            std::copy(other.mData, other.mData + mSize, mData);
+        }
         other.mData = nullptr;
         other.mSize = 0;
         //if (debug) std::cout << ">> Move Constructor: Vector has been moved\n";
@@ -56,16 +81,20 @@ public:
     // Destructor
     ~Vector() {
         if (debug) cout << "\n>> Destructor: The called vector of size " << this->mSize << " has been deleted" << endl;
-        delete[] mData;
+        release();
     }
 
     // Export mSize
     int size() const { return mSize; }
 
+    // Raw contiguous storage (0-based), for kernels
+    double* data() { return mData; }
+    const double* data() const { return mData; }
+
     // toEigen
     Vector(const Eigen::VectorXd& eigenVec)
-    : mSize(eigenVec.size()) {
-        mData = new double[mSize];
+    : mAlloc(Allocator::current()) {
+        allocate(static_cast<int>(eigenVec.size()));
         for (int i = 0; i < mSize; ++i) {
             mData[i] = eigenVec(i);
         }
@@ -85,9 +114,9 @@ public:
         if (mSize != other.mSize) {
             throw runtime_error("\n>> Error: Cannot add vectors with different sizes.");
         }
-        double* newData = new double[mSize];
-        for (int i = 0; i < mSize; ++i) newData[i] = mData[i] + other.mData[i];
-        return Vector(mSize, newData);
+        Vector result(mSize, Uninitialized());
+        VectorKernels::axpy(1.0, other.mData, mData, result.mData, mSize);
+        return result;
     }
 
     // Subtraction
@@ -95,24 +124,25 @@ public:
         if (mSize != other.mSize) {
             throw runtime_error("\n>> Error: Cannot subtract vectors with different sizes.");
         }
-        double* newData = new double[mSize];
-        for (int i = 0; i < mSize; ++i) newData[i] = mData[i] - other.mData[i];
-        return Vector(mSize, newData);
+        Vector result(mSize, Uninitialized());
+        VectorKernels::axpy(-1.0, other.mData, mData, result.mData, mSize);
+        return result;
     }
 
     // Unary
     Vector operator-() const {
-        double* newData = new double[mSize];
-        for (int i = 0; i < mSize; ++i) newData[i] = -mData[i];
-        return Vector(mSize, newData);
+        Vector result(mSize, Uninitialized());
+        VectorKernels::scale(-1.0, mData, result.mData, mSize);
+        return result;
     }
 
-    // Assignment
+    // Assignment (keeps this vector's allocator, and its buffer when the sizes match)
     Vector& operator=(const Vector& other) {
         if (this != &other) {
-            delete[] mData; // Free old memory
-            this->mSize = other.mSize;
-            this->mData = new double[mSize];
+            if (mSize != other.mSize) {
+                release(); // Free old memory
+                allocate(other.mSize);
+            }
             for (int i = 0; i < mSize; i++) {
                 this->mData[i] = other.mData[i];
             }
@@ -120,23 +150,26 @@ public:
         return (*this);
     } 
 
-    // Vector multiplication
+    // Vector multiplication: one SIMD pass, which is memory bound and gains nothing from
+    // threads. Reproducible mode uses Parallel's fixed blocks and pairwise order instead.
     double operator*(const Vector& other) const {
         if (this->mSize != other.mSize) {
             throw runtime_error("\n>> Error: Cannot compute dot product of vectors with different sizes.");
         }
-        double result = 0.0;
-        for (int i = 0; i < mSize; i++) {
-            result += mData[i] * other.mData[i];
-        }
-        return result;
+        const double* a = mData;
+        const double* b = other.mData;
+        if (!Parallel::reproducible()) return VectorKernels::dot(a, b, mSize);
+        return Parallel::sum(mSize, [a, b](int begin, int end) { return VectorKernels::dot(a + begin, b + begin, end - begin); });
     }
 
+    // Euclidean norm
+    double norm() const { return std::sqrt((*this) * (*this)); }
+
     // Scalar multiplication
     Vector operator*(double scalar) const {
-        double* newData = new double[mSize];
-        for (int i = 0; i < mSize; ++i) newData[i] = mData[i] * scalar;
-        return Vector(mSize, newData);
+        Vector result(mSize, Uninitialized());
+        VectorKernels::scale(scalar, mData, result.mData, mSize);
+        return result;
     }
 
     // Bounds-check operator (1-based index)
@@ -168,6 +201,6 @@ public:
 };
 
 // Scalar multiplication (scalar * Vector) - non-member function
-Vector operator*(double scalar, const Vector& vec) {
+inline Vector operator*(double scalar, const Vector& vec) {
     return vec * scalar;
 }
\ No newline at end of file
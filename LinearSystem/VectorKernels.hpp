@@ -0,0 +1,356 @@
+// VectorKernels.hpp
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <stdexcept>
+#include <atomic>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VECTOR_KERNELS_X86 1
+#endif
+
+// Dot, axpy, scale, sum of squared differences and norm on raw double arrays, with
+// SSE2 / AVX2 / AVX-512 variants chosen at runtime from CPUID.
+//
+// Reductions are deterministic across variants: every variant keeps the same 16 logical
+// accumulators (element i goes to accumulator i % 16, in order), adds the tail the same
+// way and combines the accumulators with the same pairwise tree. Products and sums are
+// never fused (no FMA), so all variants return bitwise identical results.
+// Contraction into FMA is also switched off for the compiler in this header (GCC does not
+// implement the STDC pragma, clang does not implement optimize()).
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+class VectorKernels {
+public:
+    enum class Variant { Scalar, SSE2, AVX2, AVX512 };
+
+private:
+    static const int kAcc = 16;
+
+    struct Table {
+        Variant variant;
+        double (*dot)(const double*, const double*, size_t);
+        double (*sumSqDiff)(const double*, const double*, size_t);
+        void (*axpy)(double, const double*, const double*, double*, size_t);
+        void (*scale)(double, const double*, double*, size_t);
+    };
+
+    // Tail elements go to accumulator (i % 16), then a fixed pairwise tree
+    static double combine(double* acc) {
+        for (int w = kAcc / 2; w >= 1; w /= 2)
+            for (int k = 0; k < w; ++k) acc[k] += acc[k + w];
+        return acc[0];
+    }
+
+    static double dotTail(double* acc, const double* a, const double* b, size_t rem) {
+        for (size_t k = 0; k < rem; ++k) acc[k] += a[k] * b[k];
+        return combine(acc);
+    }
+
+    static double sumSqDiffTail(double* acc, const double* a, const double* b, size_t rem) {
+        for (size_t k = 0; k < rem; ++k) {
+            double d = a[k] - b[k];
+            acc[k] += d * d;
+        }
+        return combine(acc);
+    }
+
+    // ---- Portable reference (also used on non-x86) ----
+    static double dotScalar(const double* a, const double* b, size_t n) {
+        double acc[kAcc] = {};
+        size_t i = 0;
+        for (; i + kAcc <= n; i += kAcc)
+            for (int k = 0; k < kAcc; ++k) acc[k] += a[i + k] * b[i + k];
+        return dotTail(acc, a + i, b + i, n - i);
+    }
+
+    static double sumSqDiffScalar(const double* a, const double* b, size_t n) {
+        double acc[kAcc] = {};
+        size_t i = 0;
+        for (; i + kAcc <= n; i += kAcc)
+            for (int k = 0; k < kAcc; ++k) {
+                double d = a[i + k] - b[i + k];
+                acc[k] += d * d;
+            }
+        return sumSqDiffTail(acc, a + i, b + i, n - i);
+    }
+
+    // out = y + alpha x (out may alias x or y)
+    static void axpyScalar(double alpha, const double* x, const double* y, double* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) out[i] = y[i] + alpha * x[i];
+    }
+
+    static void scaleScalar(double alpha, const double* x, double* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) out[i] = alpha * x[i];
+    }
+
+#ifdef VECTOR_KERNELS_X86
+    // ---- SSE2: 8 registers x 2 lanes ----
+    __attribute__((target("sse2")))
+    static double dotSSE2(const double* a, const double* b, size_t n) {
+        __m128d s0 = _mm_setzero_pd(), s1 = s0, s2 = s0, s3 = s0, s4 = s0, s5 = s0, s6 = s0, s7 = s0;
+        size_t i = 0;
+        for (; i + kAcc <= n; i += kAcc) {
+            s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+            s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+            s2 = _mm_add_pd(s2, _mm_mul_pd(_mm_loadu_pd(a + i + 4), _mm_loadu_pd(b + i + 4)));
+            s3 = _mm_add_pd(s3, _mm_mul_pd(_mm_loadu_pd(a + i + 6), _mm_loadu_pd(b + i + 6)));
+            s4 = _mm_add_pd(s4, _mm_mul_pd(_mm_loadu_pd(a + i + 8), _mm_loadu_pd(b + i + 8)));
+            s5 = _mm_add_pd(s5, _mm_mul_pd(_mm_loadu_pd(a + i + 10), _mm_loadu_pd(b + i + 10)));
+            s6 = _mm_add_pd(s6, _mm_mul_pd(_mm_loadu_pd(a + i + 12), _mm_loadu_pd(b + i + 12)));
+            s7 = _mm_add_pd(s7, _mm_mul_pd(_mm_loadu_pd(a + i + 14), _mm_loadu_pd(b + i + 14)));
+        }
+        double acc[kAcc];
+        _mm_storeu_pd(acc, s0); _mm_storeu_pd(acc + 2, s1); _mm_storeu_pd(acc + 4, s2); _mm_storeu_pd(acc + 6, s3);
+        _mm_storeu_pd(acc + 8, s4); _mm_storeu_pd(acc + 10, s5); _mm_storeu_pd(acc + 12, s6); _mm_storeu_pd(acc + 14, s7);
+        return dotTail(acc, a + i, b + i, n - i);
+    }
+
+    __attribute__((target("sse2")))
+    static double sumSqDiffSSE2(const double* a, const double* b, size_t n) {
+        __m128d s[8];
+        for (int r = 0; r < 8; ++r) s[r] = _mm_setzero_pd();
+        size_t i = 0;
+        for (; i + kAcc <= n; i += kAcc) {
+            for (int r = 0; r < 8; ++r) {
+                __m128d d = _mm_sub_pd(_mm_loadu_pd(a + i + 2 * r), _mm_loadu_pd(b + i + 2 * r));
+                s[r] = _mm_add_pd(s[r], _mm_mul_pd(d, d));
+            }
+        }
+        double acc[kAcc];
+        for (int r = 0; r < 8; ++r) _mm_storeu_pd(acc + 2 * r, s[r]);
+        return sumSqDiffTail(acc, a + i, b + i, n - i);
+    }
+
+    __attribute__((target("sse2")))
+    static void axpySSE2(double alpha, const double* x, const double* y, double* out, size_t n) {
+        __m128d va = _mm_set1_pd(alpha);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128d r0 = _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(va, _mm_loadu_pd(x + i)));
+            __m128d r1 = _mm_add_pd(_mm_loadu_pd(y + i + 2), _mm_mul_pd(va, _mm_loadu_pd(x + i + 2)));
+            _mm_storeu_pd(out + i, r0);
+            _mm_storeu_pd(out + i + 2, r1);
+        }
+        axpyScalar(alpha, x + i, y + i, out + i, n - i);
+    }
+
+    __attribute__((target("sse2")))
+    static void scaleSSE2(double alpha, const double* x, double* out, size_t n) {
+        __m128d va = _mm_set1_pd(alpha);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_pd(out + i, _mm_mul_pd(va, _mm_loadu_pd(x + i)));
+            _mm_storeu_pd(out + i + 2, _mm_mul_pd(va, _mm_loadu_pd(x + i + 2)));
+        }
+        scaleScalar(alpha, x + i, out + i, n - i);
+    }
+
+    // ---- AVX2: 4 registers x 4 lanes (no "fma" target, so nothing can be fused) ----
+    __attribute__((target("avx2")))
+    static double dotAVX2(const double* a, const double* b, size_t n) {
+        __m256d s0 = _mm256_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+        size_t i = 0;
+        for (; i + kAcc <= n; i += kAcc) {
+            s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+            s1 = _mm256_add_pd(s1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+            s2 = _mm256_add_pd(s2, _mm256_mul_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8)));
+            s3 = _mm256_add_pd(s3, _mm256_mul_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12)));
+        }
+        double acc[kAcc];
+        _mm256_storeu_pd(acc, s0); _mm256_storeu_pd(acc + 4, s1);
+        _mm256_storeu_pd(acc + 8, s2); _mm256_storeu_pd(acc + 12, s3);
+        return dotTail(acc, a + i, b + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    static double sumSqDiffAVX2(const double* a, const double* b, size_t n) {
+        __m256d s0 = _mm256_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+        size_t i = 0;
+        for (; i + kAcc <= n; i += kAcc) {
+            __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+            __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4));
+            __m256d d2 = _mm256_sub_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8));
+            __m256d d3 = _mm256_sub_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12));
+            s0 = _mm256_add_pd(s0, _mm256_mul_pd(d0, d0));
+            s1 = _mm256_add_pd(s1, _mm256_mul_pd(d1, d1));
+            s2 = _mm256_add_pd(s2, _mm256_mul_pd(d2, d2));
+            s3 = _mm256_add_pd(s3, _mm256_mul_pd(d3, d3));
+        }
+        double acc[kAcc];
+        _mm256_storeu_pd(acc, s0); _mm256_storeu_pd(acc + 4, s1);
+        _mm256_storeu_pd(acc + 8, s2); _mm256_storeu_pd(acc + 12, s3);
+        return sumSqDiffTail(acc, a + i, b + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    static void axpyAVX2(double alpha, const double* x, const double* y, double* out, size_t n) {
+        __m256d va = _mm256_set1_pd(alpha);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256d r0 = _mm256_add_pd(_mm256_loadu_pd(y + i), _mm256_mul_pd(va, _mm256_loadu_pd(x + i)));
+            __m256d r1 = _mm256_add_pd(_mm256_loadu_pd(y + i + 4), _mm256_mul_pd(va, _mm256_loadu_pd(x + i + 4)));
+            _mm256_storeu_pd(out + i, r0);
+            _mm256_storeu_pd(out + i + 4, r1);
+        }
+        axpyScalar(alpha, x + i, y + i, out + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    static void scaleAVX2(double alpha, const double* x, double* out, size_t n) {
+        __m256d va = _mm256_set1_pd(alpha);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_pd(out + i, _mm256_mul_pd(va, _mm256_loadu_pd(x + i)));
+            _mm256_storeu_pd(out + i + 4, _mm256_mul_pd(va, _mm256_loadu_pd(x + i + 4)));
+        }
+        scaleScalar(alpha, x + i, out + i, n - i);
+    }
+
+    // ---- AVX-512: 2 registers x 8 lanes ----
+    __attribute__((target("avx512f")))
+    static double dotAVX512(const double* a, const double* b, size_t n) {
+        __m512d s0 = _mm512_setzero_pd(), s1 = s0;
+        size_t i = 0;
+        for (; i + kAcc <= n; i += kAcc) {
+            s0 = _mm512_add_pd(s0, _mm512_mul_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+            s1 = _mm512_add_pd(s1, _mm512_mul_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8)));
+        }
+        double acc[kAcc];
+        _mm512_storeu_pd(acc, s0);
+        _mm512_storeu_pd(acc + 8, s1);
+        return dotTail(acc, a + i, b + i, n - i);
+    }
+
+    __attribute__((target("avx512f")))
+    static double sumSqDiffAVX512(const double* a, const double* b, size_t n) {
+        __m512d s0 = _mm512_setzero_pd(), s1 = s0;
+        size_t i = 0;
+        for (; i + kAcc <= n; i += kAcc) {
+            __m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i));
+            __m512d d1 = _mm512_sub_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8));
+            s0 = _mm512_add_pd(s0, _mm512_mul_pd(d0, d0));
+            s1 = _mm512_add_pd(s1, _mm512_mul_pd(d1, d1));
+        }
+        double acc[kAcc];
+        _mm512_storeu_pd(acc, s0);
+        _mm512_storeu_pd(acc + 8, s1);
+        return sumSqDiffTail(acc, a + i, b + i, n - i);
+    }
+
+    __attribute__((target("avx512f")))
+    static void axpyAVX512(double alpha, const double* x, const double* y, double* out, size_t n) {
+        __m512d va = _mm512_set1_pd(alpha);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512d r0 = _mm512_add_pd(_mm512_loadu_pd(y + i), _mm512_mul_pd(va, _mm512_loadu_pd(x + i)));
+            __m512d r1 = _mm512_add_pd(_mm512_loadu_pd(y + i + 8), _mm512_mul_pd(va, _mm512_loadu_pd(x + i + 8)));
+            _mm512_storeu_pd(out + i, r0);
+            _mm512_storeu_pd(out + i + 8, r1);
+        }
+        axpyScalar(alpha, x + i, y + i, out + i, n - i);
+    }
+
+    __attribute__((target("avx512f")))
+    static void scaleAVX512(double alpha, const double* x, double* out, size_t n) {
+        __m512d va = _mm512_set1_pd(alpha);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_pd(out + i, _mm512_mul_pd(va, _mm512_loadu_pd(x + i)));
+            _mm512_storeu_pd(out + i + 8, _mm512_mul_pd(va, _mm512_loadu_pd(x + i + 8)));
+        }
+        scaleScalar(alpha, x + i, out + i, n - i);
+    }
+#endif
+
+    static const Table* table(Variant v) {
+        static const Table scalar{Variant::Scalar, dotScalar, sumSqDiffScalar, axpyScalar, scaleScalar};
+#ifdef VECTOR_KERNELS_X86
+        static const Table sse2{Variant::SSE2, dotSSE2, sumSqDiffSSE2, axpySSE2, scaleSSE2};
+        static const Table avx2{Variant::AVX2, dotAVX2, sumSqDiffAVX2, axpyAVX2, scaleAVX2};
+        static const Table avx512{Variant::AVX512, dotAVX512, sumSqDiffAVX512, axpyAVX512, scaleAVX512};
+        switch (v) {
+            case Variant::AVX512: return &avx512;
+            case Variant::AVX2: return &avx2;
+            case Variant::SSE2: return &sse2;
+            default: break;
+        }
+#endif
+        return &scalar;
+    }
+
+    // Best supported variant, detected once; setVariant may swap it while other threads
+    // are running kernels, so the table is published through an atomic pointer
+    static std::atomic<const Table*>& activeTable() {
+        static std::atomic<const Table*> t(table(best()));
+        return t;
+    }
+
+    static const Table& active() { return *activeTable().load(std::memory_order_acquire); }
+
+public:
+    static bool supported(Variant v) {
+        switch (v) {
+            case Variant::Scalar: return true;
+#ifdef VECTOR_KERNELS_X86
+            case Variant::SSE2: return __builtin_cpu_supports("sse2");
+            case Variant::AVX2: return __builtin_cpu_supports("avx2");
+            case Variant::AVX512: return __builtin_cpu_supports("avx512f");
+#endif
+            default: return false;
+        }
+    }
+
+    static Variant best() {
+        for (Variant v : {Variant::AVX512, Variant::AVX2, Variant::SSE2})
+            if (supported(v)) return v;
+        return Variant::Scalar;
+    }
+
+    // Force a variant (benchmarks, tests); results do not change, only speed
+    static void setVariant(Variant v) {
+        if (!supported(v)) throw std::runtime_error("\nError: " + std::string(name(v)) + " is not supported by this CPU.");
+        activeTable().store(table(v), std::memory_order_release);
+    }
+
+    static Variant variant() { return active().variant; }
+
+    static const char* name(Variant v) {
+        switch (v) {
+            case Variant::SSE2: return "SSE2";
+            case Variant::AVX2: return "AVX2";
+            case Variant::AVX512: return "AVX-512";
+            default: return "Scalar";
+        }
+    }
+
+    // Short inputs skip the dispatch: the scalar reference gives the same bits
+    static double dot(const double* a, const double* b, size_t n) {
+        return n < 2 * kAcc ? dotScalar(a, b, n) : active().dot(a, b, n);
+    }
+
+    // sum_i (a_i - b_i)^2
+    static double sumSqDiff(const double* a, const double* b, size_t n) {
+        return n < 2 * kAcc ? sumSqDiffScalar(a, b, n) : active().sumSqDiff(a, b, n);
+    }
+
+    static double norm(const double* x, size_t n) { return std::sqrt(dot(x, x, n)); }
+
+    // out = y + alpha x (out may alias x or y)
+    static void axpy(double alpha, const double* x, const double* y, double* out, size_t n) { active().axpy(alpha, x, y, out, n); }
+
+    // out = alpha x (out may alias x)
+    static void scale(double alpha, const double* x, double* out, size_t n) { active().scale(alpha, x, out, n); }
+};
+
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT DEFAULT
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif